@@ -0,0 +1,194 @@
+#include "FlowTable/FlowTable.hpp"
+#include "NewFlowTable.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <rte_eal.h>
+#include <rte_hash_crc.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <vector>
+
+// Head-to-head runs of FlowTable and NewFlowTable on identical flow workloads. Every benchmark is a
+// template over the engine, both engines see the same five tuples and the same hashes.
+
+static bool ensureEal()
+{
+    static const bool initialized = [] {
+        const char *args[] = {"cheetah-flow-benchmarks", "-l", "0", "--in-memory", NULL};
+        if (rte_eal_init(4, const_cast<char **>(args)) < 0)
+        {
+            std::cerr << "Failed to initialize EAL" << std::endl;
+            return false;
+        }
+        return true;
+    }();
+    return initialized;
+}
+
+static size_t heapAllocatedBytes()
+{
+    rte_malloc_socket_stats stats{};
+    rte_malloc_get_socket_stats(rte_socket_id(), &stats);
+    return stats.heap_allocsz_bytes;
+}
+
+class FlowWorkload
+{
+  public:
+    std::vector<FiveTuple> mFiveTuples;
+    std::vector<uint32_t> mHashes;
+
+    /// `count` distinct flows, half of them seen from their reverse direction. The hash is computed over
+    /// the canonical tuple, standing in for a symmetric RSS hash.
+    FlowWorkload(const size_t count, const uint32_t seed) : mFiveTuples(count), mHashes(count)
+    {
+        std::mt19937 generator(seed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            FiveTuple fiveTuple{.mSourceAddress = static_cast<uint32_t>(generator()),
+                                .mDestinationAddress = static_cast<uint32_t>(generator()),
+                                .mSourcePort = static_cast<uint16_t>(generator()),
+                                .mDestinationPort = static_cast<uint16_t>(i),
+                                .mProtocol = 6};
+            const FiveTuple canonicalFiveTuple = fiveTuple.canonical();
+            mFiveTuples[i] = (i & 1) ? !fiveTuple : fiveTuple;
+            mHashes[i] = rte_hash_crc(&canonicalFiveTuple, sizeof(canonicalFiveTuple), 0);
+        }
+    }
+};
+
+template <typename TEngine>
+static void fill(TEngine &engine, const FlowWorkload &workload)
+{
+    for (size_t i = 0; i < workload.mFiveTuples.size(); ++i)
+        engine.insert(workload.mHashes[i], workload.mFiveTuples[i], 10);
+}
+
+template <typename TEngine>
+static void drain(TEngine &engine, const FlowWorkload &workload)
+{
+    for (size_t i = 0; i < workload.mFiveTuples.size(); ++i)
+        engine.delete_entry(workload.mHashes[i], engine.lookup(workload.mHashes[i], workload.mFiveTuples[i]));
+}
+
+/// Insert rate into an empty table, and the heap footprint of the filled table
+template <typename TEngine>
+static void BM_FlowEngineInsert(benchmark::State &state)
+{
+    if (!ensureEal())
+    {
+        state.SkipWithError("EAL initialization failed");
+        return;
+    }
+
+    const FlowWorkload workload(state.range(0), 1);
+    const size_t heapBefore = heapAllocatedBytes();
+    auto engine = std::make_unique<TEngine>();
+    fill(*engine, workload);
+    const size_t tableBytes = heapAllocatedBytes() - heapBefore;
+    drain(*engine, workload);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < workload.mFiveTuples.size(); ++i)
+            benchmark::DoNotOptimize(engine->insert(workload.mHashes[i], workload.mFiveTuples[i], 10));
+
+        state.PauseTiming();
+        drain(*engine, workload);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * workload.mFiveTuples.size());
+    state.counters["table_MiB"] = static_cast<double>(tableBytes) / (1 << 20);
+    state.counters["bytes_per_flow"] = static_cast<double>(tableBytes) / workload.mFiveTuples.size();
+}
+
+/// Lookups of tracked flows, in both directions
+template <typename TEngine>
+static void BM_FlowEngineLookupHit(benchmark::State &state)
+{
+    if (!ensureEal())
+    {
+        state.SkipWithError("EAL initialization failed");
+        return;
+    }
+
+    const FlowWorkload workload(state.range(0), 1);
+    auto engine = std::make_unique<TEngine>();
+    fill(*engine, workload);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < workload.mFiveTuples.size(); ++i)
+            benchmark::DoNotOptimize(engine->lookup(workload.mHashes[i], workload.mFiveTuples[i]));
+    }
+
+    state.SetItemsProcessed(state.iterations() * workload.mFiveTuples.size());
+}
+
+/// Lookups of untracked flows against a filled table
+template <typename TEngine>
+static void BM_FlowEngineLookupMiss(benchmark::State &state)
+{
+    if (!ensureEal())
+    {
+        state.SkipWithError("EAL initialization failed");
+        return;
+    }
+
+    const FlowWorkload workload(state.range(0), 1);
+    const FlowWorkload missWorkload(state.range(0), 2);
+    auto engine = std::make_unique<TEngine>();
+    fill(*engine, workload);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < missWorkload.mFiveTuples.size(); ++i)
+            benchmark::DoNotOptimize(engine->lookup(missWorkload.mHashes[i], missWorkload.mFiveTuples[i]));
+    }
+
+    state.SetItemsProcessed(state.iterations() * missWorkload.mFiveTuples.size());
+}
+
+/// Steady-state churn: every flow of a filled table is replaced by a new one, one delete and one insert
+/// per item
+template <typename TEngine>
+static void BM_FlowEngineChurn(benchmark::State &state)
+{
+    if (!ensureEal())
+    {
+        state.SkipWithError("EAL initialization failed");
+        return;
+    }
+
+    const FlowWorkload workloads[2] = {FlowWorkload(state.range(0), 1), FlowWorkload(state.range(0), 2)};
+    auto engine = std::make_unique<TEngine>();
+    fill(*engine, workloads[0]);
+
+    size_t current = 0;
+    for (auto _ : state)
+    {
+        const FlowWorkload &retiring = workloads[current];
+        const FlowWorkload &arriving = workloads[current ^ 1];
+        for (size_t i = 0; i < retiring.mFiveTuples.size(); ++i)
+        {
+            engine->delete_entry(retiring.mHashes[i], engine->lookup(retiring.mHashes[i], retiring.mFiveTuples[i]));
+            benchmark::DoNotOptimize(engine->insert(arriving.mHashes[i], arriving.mFiveTuples[i], 10));
+        }
+        current ^= 1;
+    }
+
+    state.SetItemsProcessed(state.iterations() * workloads[0].mFiveTuples.size());
+}
+
+BENCHMARK_TEMPLATE(BM_FlowEngineInsert, FlowTable)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineInsert, NewFlowTable<>)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineLookupHit, FlowTable)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineLookupHit, NewFlowTable<>)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineLookupMiss, FlowTable)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineLookupMiss, NewFlowTable<>)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineChurn, FlowTable)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FlowEngineChurn, NewFlowTable<>)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
@@ -1,4 +1,5 @@
 #include "FlowTable/FlowTable.hpp"
+#include <algorithm>
 #include <benchmark/benchmark.h>
 #include <cstdint>
 #include <iostream>
@@ -25,12 +26,14 @@ static void BM_FlowTableInsertion(benchmark::State &state)
         // 4. Insert flows into the pre-constructed table
         for (auto hash : hashes)
         {
-            bool result = flowTable->insert(hash, fiveTuple, 10);
+            auto result = flowTable->find_or_insert(hash, fiveTuple, [](TrackDescriptor &trackDescriptor) {
+                trackDescriptor.add_rule(std::make_tuple(10, 100), nullptr);
+            });
 
             state.PauseTiming();
-            if (!result)
+            if (!result.first)
                 std::cout << "Failed to insert flow with hash: " << hash << std::endl;
-            flowTable->delete_entry(hash, flowTable->lookup(hash, fiveTuple));
+            flowTable->delete_entry(hash, result.first);
             state.ResumeTiming();
             benchmark::DoNotOptimize(result);
         }
@@ -89,6 +92,70 @@ static void BM_FlowTableTraverseList(benchmark::State &state)
     delete flowTable;
 }
 
+static void BM_FlowTableLookupBulk(benchmark::State &state)
+{
+    constexpr uint32_t BURST_SIZE = 32;
+
+    // 1. Generate random flows once, outside the measurement loop.
+    const int range = state.range(0);
+    std::vector<uint32_t> hashes(range);
+    std::vector<FiveTuple> fiveTuplesVec(range);
+    for (int i = 0; i < range; ++i)
+    {
+        hashes[i] = static_cast<uint32_t>(rand());
+        fiveTuplesVec[i] = FiveTuple{.mSourceAddress = static_cast<uint32_t>(rand()),
+                                     .mDestinationAddress = static_cast<uint32_t>(rand()),
+                                     .mSourcePort = static_cast<uint16_t>(rand() % 65535),
+                                     .mDestinationPort = static_cast<uint16_t>(rand() % 65535),
+                                     .mProtocol = static_cast<uint8_t>(rand() % 256)};
+    }
+
+    // 2. Construct and populate the FlowTable once (expensive operation).
+    FlowTable *flowTable = new FlowTable();
+    for (int i = 0; i < range; ++i)
+        flowTable->insert(hashes[i], fiveTuplesVec[i], 10);
+
+    // 3. Benchmark loop, one burst per iteration
+    TrackDescriptor *results[BURST_SIZE];
+    uint32_t offset = 0;
+    for (auto _ : state)
+    {
+        const uint32_t count = std::min<uint32_t>(BURST_SIZE, range - offset);
+        uint32_t hits = flowTable->lookup_bulk(&hashes[offset], &fiveTuplesVec[offset], results, count);
+        benchmark::DoNotOptimize(hits);
+        benchmark::DoNotOptimize(results);
+        offset = (offset + count) % range;
+    }
+    state.SetItemsProcessed(state.iterations() * BURST_SIZE);
+    delete flowTable;
+}
+
+static void BM_FiveTupleEquality(benchmark::State &state)
+{
+    // Keys differ only in the last compared byte, the worst case for a field by field compare
+    std::vector<FiveTuple> fiveTuplesVec(256);
+    for (uint32_t i = 0; i < fiveTuplesVec.size(); ++i)
+    {
+        fiveTuplesVec[i] = FiveTuple{.mSourceAddress = 0xc0a80000,
+                                     .mDestinationAddress = 0x08080808,
+                                     .mSourcePort = 12345,
+                                     .mDestinationPort = 80,
+                                     .mProtocol = static_cast<uint8_t>(rand() % 2)};
+    }
+    const FiveTuple fiveTupleBench = fiveTuplesVec.front();
+
+    for (auto _ : state)
+    {
+        uint32_t matches = 0;
+        for (const auto &fiveTuple : fiveTuplesVec)
+            matches += (fiveTuple == fiveTupleBench);
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * fiveTuplesVec.size());
+}
+
 // Example registration
 // BENCHMARK(BM_FlowTableInsertion)->RangeMultiplier(2)->Range(1, 64);
-// BENCHMARK(BM_FlowTableTraverseList)->RangeMultiplier(2)->Range(1, 256);
\ No newline at end of file
+// BENCHMARK(BM_FlowTableTraverseList)->RangeMultiplier(2)->Range(1, 256);
+BENCHMARK(BM_FlowTableLookupBulk)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_FiveTupleEquality);
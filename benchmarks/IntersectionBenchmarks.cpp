@@ -1,8 +1,15 @@
+#include "Classifier/Classifier.hpp"
+#include "Common/Bitmap/AggregatedBitmap.hpp"
+#include "Common/Bitmap/Bitmap.hpp"
 #include "FlowTable/FlowTable.hpp"
+#include <array>
 #include <benchmark/benchmark.h>
 #include <cstdint>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <unistd.h>
+#include <vector>
 
 template <size_t BIT_COUNT>
 class MyBitset
@@ -89,6 +96,176 @@ static void IM_Test(benchmark::State &state)
     delete intersectionTable;
 }
 
+using RulesBitmap = Bitmap<65536, 10>;
+
+/// Ten 65536-bit field bitsets intersected per packet, with one of the Bitmap kernels
+template <BitsetKernels::Kernel KERNEL>
+static void BM_BitmapOperateAND(benchmark::State &state)
+{
+    if (!BitsetKernels::supported(KERNEL))
+    {
+        state.SkipWithError("Kernel not supported by this CPU");
+        return;
+    }
+
+    auto bitmap = std::make_unique<RulesBitmap>();
+    std::mt19937_64 generator(1);
+    for (auto &bitset : bitmap->getData())
+    {
+        for (size_t i = 0; i < Bitset<65536>::WORDS_COUNT; ++i)
+            bitset.data()[i] = generator() | generator();
+    }
+
+    for (auto _ : state)
+    {
+        auto result = bitmap->OperateAND(KERNEL);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(RulesBitmap));
+    state.SetLabel(BitsetKernels::name(KERNEL));
+}
+
+BENCHMARK_TEMPLATE(BM_BitmapOperateAND, BitsetKernels::Kernel::Scalar);
+BENCHMARK_TEMPLATE(BM_BitmapOperateAND, BitsetKernels::Kernel::Sse2);
+BENCHMARK_TEMPLATE(BM_BitmapOperateAND, BitsetKernels::Kernel::Avx2);
+BENCHMARK_TEMPLATE(BM_BitmapOperateAND, BitsetKernels::Kernel::Avx512);
+
+/// Highest priority match of ten sparse field bitsets, with the only common rule at bit state.range(0):
+/// the fused kernel stops there instead of materializing the whole intersection
+template <BitsetKernels::Kernel KERNEL>
+static void BM_BitmapFirstMatch(benchmark::State &state)
+{
+    if (!BitsetKernels::supported(KERNEL))
+    {
+        state.SkipWithError("Kernel not supported by this CPU");
+        return;
+    }
+
+    auto bitmap = std::make_unique<RulesBitmap>();
+    std::mt19937_64 generator(1);
+    for (auto &bitset : bitmap->getData())
+    {
+        for (size_t i = 0; i < Bitset<65536>::WORDS_COUNT; ++i)
+            bitset.data()[i] = generator() & generator() & generator(); // about 1 rule in 8 per field
+        bitset.set(state.range(0));
+    }
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bitmap->OperateANDFirst(KERNEL));
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(BitsetKernels::name(KERNEL));
+}
+
+BENCHMARK_TEMPLATE(BM_BitmapFirstMatch, BitsetKernels::Kernel::Scalar)->Arg(0)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_BitmapFirstMatch, BitsetKernels::Kernel::Sse2)->Arg(0)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_BitmapFirstMatch, BitsetKernels::Kernel::Avx2)->Arg(0)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_BitmapFirstMatch, BitsetKernels::Kernel::Avx512)->Arg(0)->Arg(4096)->Arg(65535);
+
+/// Sparse field bitsets: every field matches 8 ranges of 256 rules, 3% of the rule set
+template <typename TBitmap>
+static void fillSparse(TBitmap &bitmap)
+{
+    std::mt19937 generator(1);
+    for (auto &bitset : bitmap.getData())
+    {
+        for (int range = 0; range < 8; ++range)
+        {
+            const size_t first = generator() % (65536 - 256);
+            for (size_t rule = first; rule < first + 256; ++rule)
+                bitset.set(rule);
+        }
+        bitset.set(65000); // the rule every field shares
+    }
+}
+
+/// Full intersection of ten sparse field bitsets, flat Bitmap against the summary-driven AggregatedBitmap
+template <typename TBitmap>
+static void BM_SparseOperateAND(benchmark::State &state)
+{
+    auto bitmap = std::make_unique<TBitmap>();
+    fillSparse(*bitmap);
+
+    for (auto _ : state)
+    {
+        auto result = bitmap->OperateAND();
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TBitmap>
+static void BM_SparseFirstMatch(benchmark::State &state)
+{
+    auto bitmap = std::make_unique<TBitmap>();
+    fillSparse(*bitmap);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bitmap->OperateANDFirst());
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_SparseOperateAND, RulesBitmap);
+BENCHMARK_TEMPLATE(BM_SparseOperateAND, AggregatedBitmap<65536, 10>);
+BENCHMARK_TEMPLATE(BM_SparseFirstMatch, RulesBitmap);
+BENCHMARK_TEMPLATE(BM_SparseFirstMatch, AggregatedBitmap<65536, 10>);
+
+/// 65536 rules over 256 source /16s, 1024 destination /24s and 1024 destination ports, TCP or UDP
+static std::vector<ClassifierRule> makeClassifierRules()
+{
+    std::mt19937 generator(1);
+    std::vector<ClassifierRule> rules(65536);
+    for (ClassifierRule &rule : rules)
+    {
+        rule.mSourceAddress = 0x0a000000 | (generator() % 256) << 16;
+        rule.mSourcePrefixLength = 16;
+        rule.mDestinationAddress = 0xc0000000 | (generator() % 1024) << 8;
+        rule.mDestinationPrefixLength = 24;
+        rule.mDestinationPortLow = rule.mDestinationPortHigh = static_cast<uint16_t>(generator() % 1024);
+        rule.mProtocol = generator() % 2 ? 6 : 17;
+        rule.mProtocolMask = 0xff;
+    }
+    return rules;
+}
+
+/// Highest priority match of packets drawn from the rule space, six field lookups and one intersection
+static void BM_ClassifierClassify(benchmark::State &state)
+{
+    const auto classifier = std::make_unique<Classifier<65536>>(makeClassifierRules());
+
+    std::mt19937 generator(2);
+    std::vector<FiveTuple> packets(4096);
+    for (FiveTuple &packet : packets)
+    {
+        packet.mSourceAddress = 0x0a000000 | (generator() % 256) << 16 | (generator() & 0xffff);
+        packet.mDestinationAddress = 0xc0000000 | (generator() % 1024) << 8 | (generator() & 0xff);
+        packet.mSourcePort = static_cast<uint16_t>(generator());
+        packet.mDestinationPort = static_cast<uint16_t>(generator() % 1024);
+        packet.mProtocol = generator() % 2 ? 6 : 17;
+    }
+
+    size_t packet = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(classifier->classify(packets[packet]));
+        packet = (packet + 1) % packets.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    const ClassifierMemoryReport report = classifier->memoryReport();
+    state.counters["bitsets"] = static_cast<double>(report.mBitsetsCount);
+    state.counters["leaves"] = static_cast<double>(report.mLeavesCount);
+    state.counters["bitsetMiB"] = static_cast<double>(report.mBitsetBytes) / (1 << 20);
+    state.counters["unsharedMiB"] = static_cast<double>(report.mUnsharedBitsetBytes) / (1 << 20);
+}
+
+BENCHMARK(BM_ClassifierClassify);
+
 // Example registration
 // BENCHMARK(BM_FlowTableInsertion)->RangeMultiplier(2)->Range(1, 64);
 BENCHMARK(IM_Test)->RangeMultiplier(2)->Range(1, 256);
\ No newline at end of file
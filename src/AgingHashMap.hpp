@@ -1,49 +1,96 @@
 #pragma once
 
+#include <cerrno>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
 
+#include "Common/Eviction/EvictionPolicy.hpp"
+#include "Common/Hash/HashPolicy.hpp"
+#include "Common/TimerWheel/TimerWheel.hpp"
+
+#include <rte_cycles.h>
 #include <rte_hash.h>
-#include <rte_jhash.h>
 #include <rte_lcore.h>
 #include <rte_mempool.h>
+#include <rte_random.h>
 #include <rte_timer.h>
 
+/// How AgingHashMap tracks entry TTLs
+enum class AgingMode
+{
+    RteTimer,     // one rte_timer per entry, re-armed on every touch
+    LazyRteTimer, // one rte_timer per entry, a touch stores a timestamp and the timer re-arms itself on expiry
+    TimerWheel,   // built-in timing wheel, a touch is a single store
+};
+
 template <typename TKey, typename TValue, std::size_t Capacity = (1 << 16) - 1, typename ExpireFn = void,
           unsigned MempoolCache = RTE_MEMPOOL_CACHE_MAX_SIZE,
-          uint32_t ExtraFlags = RTE_HASH_EXTRA_FLAGS_EXT_TABLE | RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY>
+          uint32_t ExtraFlags = RTE_HASH_EXTRA_FLAGS_EXT_TABLE | RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY,
+          AgingMode Mode = AgingMode::TimerWheel, typename HashPolicy = JHashPolicy>
 class AgingHashMap
 {
 
   private:
+    static constexpr bool USE_TIMER_WHEEL = (Mode == AgingMode::TimerWheel);
+    static constexpr bool USE_LAZY_RTE_TIMER = (Mode == AgingMode::LazyRteTimer);
+    static constexpr uint64_t TIMER_WHEEL_TICKS_PER_SEC = 100; // 10 ms granularity
+    static constexpr uint32_t TIMER_WHEEL_MIN_SLOTS = 256;
+    static constexpr uint32_t EVICTION_HIGH_WATERMARK = Capacity - Capacity / 16;
+    static constexpr uint32_t EVICTION_SAMPLE_SIZE = 8;
+
     uint64_t m_TtlTicks;
     rte_mempool *m_Mempool{nullptr};
     rte_hash *m_Hash{nullptr};
     std::conditional_t<std::is_void<ExpireFn>::value, char, ExpireFn>
         m_ExpireFunction; // Only define this member if ExpireFn is not void
     int8_t m_SocketId;
+    std::conditional_t<USE_TIMER_WHEEL, TimerWheel, char> m_TimerWheel; // Only used in TimerWheel mode
+    uint64_t m_CoarseNow; // Timestamp of the last manageTimers(), only used in LazyRteTimer mode
+    EvictionPolicy m_EvictionPolicy{EvictionPolicy::None};
+    uint32_t m_EvictionHighWatermark{EVICTION_HIGH_WATERMARK};
+    uint32_t m_EvictionSampleSize{EVICTION_SAMPLE_SIZE};
+    EvictionStats m_EvictionStats;
 
     static_assert(std::is_trivially_copyable<TKey>::value, "TKey must be trivially copyable for rte_hash");
+    static_assert(std::has_unique_object_representations<TKey>::value,
+                  "TKey must not have implicit padding, rte_hash hashes and compares its raw bytes");
+
+    struct RteTimerNode
+    {
+        rte_timer timer;
+    };
 
-    struct Entry
+    struct LazyRteTimerNode : RteTimerNode
+    {
+        uint64_t lastAccess;
+    };
+
+    using TimerNode = std::conditional_t<USE_TIMER_WHEEL, TimerWheel::Node,
+                                         std::conditional_t<USE_LAZY_RTE_TIMER, LazyRteTimerNode, RteTimerNode>>;
+
+    /// The timing wheel links entries through their TimerWheel::Node base
+    struct Entry : TimerNode
     {
         TKey key;
         TValue value;
-        rte_timer timer;
         AgingHashMap *parent;
+        hash_sig_t hash; // the hash the entry was inserted with
     };
 
   public:
     /// @param base_name unique prefix for mempool+hash names
     /// @param ttl_sec   how many seconds until an entry expires
     /// @param socket_id which DPDK socket to allocate on
-    template <typename F = ExpireFn, typename = std::enable_if_t<!std::is_void<F>::value>>
-    AgingHashMap(const std::string &base_name, F expire_func, uint64_t ttl_sec = 3, int socket_id = SOCKET_ID_ANY)
+    // expire_func is not deduced, so (base_name, ttl_sec) resolves to the constructor below
+    template <typename F = ExpireFn>
+    AgingHashMap(const std::string &base_name, std::enable_if_t<!std::is_void<F>::value, F> expire_func,
+                 uint64_t ttl_sec = 3, int socket_id = SOCKET_ID_ANY)
         : m_TtlTicks(ttl_sec * rte_get_timer_hz())
         , m_ExpireFunction(expire_func)
         , m_SocketId(socket_id)
+        , m_CoarseNow(rte_get_timer_cycles())
     {
         init(base_name);
     }
@@ -52,7 +99,7 @@ class AgingHashMap
     AgingHashMap(const std::string &base_name, uint64_t ttl_sec = 3, int socket_id = SOCKET_ID_ANY)
         : m_TtlTicks(ttl_sec * rte_get_timer_hz())
         , m_SocketId(socket_id)
-
+        , m_CoarseNow(rte_get_timer_cycles())
     {
         init(base_name);
     }
@@ -77,6 +124,12 @@ class AgingHashMap
         , m_TtlTicks(other.m_TtlTicks)
         , m_Mempool(other.m_Mempool)
         , m_Hash(other.m_Hash)
+        , m_TimerWheel(std::move(other.m_TimerWheel))
+        , m_CoarseNow(other.m_CoarseNow)
+        , m_EvictionPolicy(other.m_EvictionPolicy)
+        , m_EvictionHighWatermark(other.m_EvictionHighWatermark)
+        , m_EvictionSampleSize(other.m_EvictionSampleSize)
+        , m_EvictionStats(other.m_EvictionStats)
     {
         if constexpr (!std::is_void<ExpireFn>::value)
             m_ExpireFunction = other.m_ExpireFunction;
@@ -101,6 +154,12 @@ class AgingHashMap
             m_TtlTicks = other.m_TtlTicks;
             m_Mempool = other.m_Mempool;
             m_Hash = other.m_Hash;
+            m_TimerWheel = std::move(other.m_TimerWheel);
+            m_CoarseNow = other.m_CoarseNow;
+            m_EvictionPolicy = other.m_EvictionPolicy;
+            m_EvictionHighWatermark = other.m_EvictionHighWatermark;
+            m_EvictionSampleSize = other.m_EvictionSampleSize;
+            m_EvictionStats = other.m_EvictionStats;
             if constexpr (!std::is_void<ExpireFn>::value)
                 m_ExpireFunction = other.m_ExpireFunction;
 
@@ -111,10 +170,54 @@ class AgingHashMap
         return *this;
     }
 
-    /// Must be driven periodically on one lcore
+    /// Enables capacity-pressure eviction: once `highWatermark` entries are stored, inserting a new key first
+    /// evicts the least recently used of `sampleSize` entries sampled from a random position of the hash,
+    /// and an insert that finds the mempool empty evicts and retries once. Evicted entries go through the
+    /// expire function, if any, but are removed whatever it returns. Only EvictionPolicy::SampledLru is
+    /// supported, rte_hash does not expose its buckets.
+    void set_eviction(const EvictionPolicy policy, const uint32_t highWatermark = EVICTION_HIGH_WATERMARK,
+                      const uint32_t sampleSize = EVICTION_SAMPLE_SIZE)
+    {
+        if (policy != EvictionPolicy::None && policy != EvictionPolicy::SampledLru)
+            throw std::invalid_argument("AgingHashMap only supports EvictionPolicy::SampledLru");
+
+        m_EvictionPolicy = policy;
+        m_EvictionHighWatermark = highWatermark;
+        m_EvictionSampleSize = sampleSize ? sampleSize : 1;
+    }
+
+    /// Sub-second TTL, in rte_get_timer_hz() ticks. Applies to the entries armed or touched from now on.
+    void set_ttl_ticks(const uint64_t ttlTicks) noexcept
+    {
+        m_TtlTicks = ttlTicks;
+    }
+
+    uint64_t ttl_ticks() const noexcept
+    {
+        return m_TtlTicks;
+    }
+
+    const EvictionStats &evictionStats() const noexcept
+    {
+        return m_EvictionStats;
+    }
+
+    /// Must be driven periodically on one lcore. In TimerWheel mode, expires the entries of every
+    /// elapsed tick in one batch and only then moves touched entries to their new slot. That lcore is also
+    /// the only writer in TimerWheel mode: try_emplace, erase, clear and manageTimers relink the wheel and
+    /// must not run concurrently, while reader lcores may lookup<true>() since a touch is an atomic store.
     void manageTimers()
     {
-        rte_timer_manage();
+        if constexpr (USE_TIMER_WHEEL)
+        {
+            m_TimerWheel.advance(rte_get_timer_cycles(),
+                                 [](TimerWheel::Node *node) { expire(static_cast<Entry *>(node)); });
+        }
+        else
+        {
+            m_CoarseNow = rte_get_timer_cycles();
+            rte_timer_manage();
+        }
     }
 
     // /// Insert or update (reset TTL). Returns pointer to value or nullptr on failure.
@@ -187,34 +290,53 @@ class AgingHashMap
 
     template <typename... Args>
     TValue *try_emplace(const TKey &key, Args &&... args)
+    {
+        return try_emplace_with_hash(key, rte_hash_hash(m_Hash, &key), std::forward<Args>(args)...);
+    }
+
+    /// try_emplace() with a precomputed hash, e.g. the NIC RSS value. Every later access to the entry
+    /// must use the same hash through the *_with_hash methods, unless it matches what HashPolicy computes.
+    template <typename... Args>
+    TValue *try_emplace_with_hash(const TKey &key, const hash_sig_t hash, Args &&... args)
     {
         static_assert(std::is_constructible<TValue, Args...>::value,
                       "TValue must be constructible from provided arguments");
 
         Entry *entry = nullptr;
 
-        if (rte_hash_lookup_data(m_Hash, &key, (void **)&entry) >= 0)
+        if (rte_hash_lookup_with_hash_data(m_Hash, &key, hash, (void **)&entry) >= 0)
         {
             scheduleTimer(entry);
             return &entry->value;
         }
 
+        if (m_EvictionPolicy != EvictionPolicy::None && size() >= m_EvictionHighWatermark)
+            evict();
+
         if (rte_mempool_get(m_Mempool, (void **)&entry) < 0)
-            return nullptr;
+        {
+            if (m_EvictionPolicy == EvictionPolicy::None || !evict() || rte_mempool_get(m_Mempool, (void **)&entry) < 0)
+            {
+                ++m_EvictionStats.mInsertFailures;
+                return nullptr;
+            }
+        }
 
         new (&entry->value) TValue(std::forward<Args>(args)...);
         entry->key = key;
         entry->parent = this;
-        rte_timer_init(&entry->timer);
+        entry->hash = hash;
+        initTimer(entry);
 
-        if (rte_hash_add_key_data(m_Hash, &entry->key, entry) < 0)
+        if (rte_hash_add_key_with_hash_data(m_Hash, &entry->key, hash, entry) < 0)
         {
             entry->value.~TValue();
             rte_mempool_put(m_Mempool, entry);
+            ++m_EvictionStats.mInsertFailures;
             return nullptr;
         }
 
-        scheduleTimer(entry);
+        armTimer(entry);
         return &entry->value;
     }
 
@@ -233,21 +355,128 @@ class AgingHashMap
         // return (rte_hash_lookup_data(m_Hash, &key, (void **)&entry) >= 0) ? &entry->value : nullptr;
     }
 
+    /// lookup() with a precomputed hash, skips hashing the key
+    template <bool ExtendTTL = false>
+    TValue *lookup_with_hash(const TKey &key, const hash_sig_t hash) const noexcept
+    {
+        Entry *entry = nullptr;
+        if ((rte_hash_lookup_with_hash_data(m_Hash, &key, hash, (void **)&entry) >= 0))
+        {
+            if constexpr (ExtendTTL)
+                scheduleTimer(entry);
+            return &entry->value;
+        }
+        return nullptr;
+    }
+
     /// Remove immediately. Returns true if an entry was erased.
     bool erase(const TKey &key)
+    {
+        return erase_with_hash(key, rte_hash_hash(m_Hash, &key));
+    }
+
+    /// erase() with a precomputed hash
+    bool erase_with_hash(const TKey &key, const hash_sig_t hash)
     {
         Entry *entry = nullptr;
-        if (rte_hash_lookup_data(m_Hash, &key, (void **)&entry) < 0)
+        if (rte_hash_lookup_with_hash_data(m_Hash, &key, hash, (void **)&entry) < 0)
             return false;
-        if (rte_hash_del_key(m_Hash, &key) < 0)
+        if (rte_hash_del_key_with_hash(m_Hash, &key, hash) < 0)
             return false;
 
-        rte_timer_stop(&entry->timer);
+        stopTimer(entry);
         entry->value.~TValue();
         rte_mempool_put(m_Mempool, entry);
         return true;
     }
 
+    /// Bulk lookup of up to RTE_HASH_LOOKUP_BULK_MAX keys through rte_hash_lookup_bulk_data, which
+    /// pipelines the bucket accesses of the whole burst.
+    /// @param values  filled with the value of each key, nullptr on a miss
+    /// @param hitMask optional, bit i is set when keys[i] was found
+    /// @return number of hits, -EINVAL if n is out of range
+    template <bool ExtendTTL = false>
+    int lookup_bulk(const TKey *keys, const uint32_t n, TValue **values, uint64_t *hitMask = nullptr) const noexcept
+    {
+        return lookupBulk<ExtendTTL>(keys, nullptr, n, values, hitMask);
+    }
+
+    /// lookup_bulk() with precomputed hashes
+    template <bool ExtendTTL = false>
+    int lookup_bulk_with_hash(const TKey *keys, const hash_sig_t *hashes, const uint32_t n, TValue **values,
+                              uint64_t *hitMask = nullptr) const noexcept
+    {
+        return lookupBulk<ExtendTTL>(keys, hashes, n, values, hitMask);
+    }
+
+    /// Bulk try_emplace() of up to RTE_HASH_LOOKUP_BULK_MAX keys. Existing keys are resolved by one bulk
+    /// lookup and get their TTL extended, the missing ones are inserted with a copy of `values[i]`.
+    /// @param out        filled with the value of each key, nullptr when it could not be inserted
+    /// @param failedMask optional, bit i is set when keys[i] could not be inserted (e.g. pool exhausted)
+    /// @return number of non-null `out` entries, a key repeated in the burst counting once per occurrence;
+    ///         -EINVAL if n is out of range
+    int try_emplace_bulk(const TKey *keys, const TValue *values, const uint32_t n, TValue **out,
+                         uint64_t *failedMask = nullptr)
+    {
+        uint64_t hits = 0;
+        uint64_t failed = 0;
+
+        const int hitsCount = lookup_bulk<true>(keys, n, out, &hits);
+        if (hitsCount < 0)
+            return hitsCount;
+
+        int present = hitsCount;
+        for (uint64_t misses = ~hits & (n == 64 ? ~0ULL : ((1ULL << n) - 1)); misses; misses &= misses - 1)
+        {
+            // Also covers keys that appear twice in the burst
+            const uint32_t i = __builtin_ctzll(misses);
+            out[i] = try_emplace(keys[i], values[i]);
+            if (out[i] == nullptr)
+                failed |= 1ULL << i;
+            else
+                ++present;
+        }
+
+        if (failedMask)
+            *failedMask = failed;
+        return present;
+    }
+
+    /// Bulk erase() of up to RTE_HASH_LOOKUP_BULK_MAX keys
+    /// @return number of erased entries, -EINVAL if n is out of range
+    int erase_bulk(const TKey *keys, const uint32_t n)
+    {
+        const void *keyPtrs[RTE_HASH_LOOKUP_BULK_MAX];
+        void *entries[RTE_HASH_LOOKUP_BULK_MAX];
+        uint64_t hits = 0;
+        int erased = 0;
+
+        if (n == 0 || n > RTE_HASH_LOOKUP_BULK_MAX)
+            return -EINVAL;
+
+        for (uint32_t i = 0; i < n; ++i)
+            keyPtrs[i] = &keys[i];
+
+        if (rte_hash_lookup_bulk_data(m_Hash, keyPtrs, n, &hits, entries) < 0)
+            return -EINVAL;
+
+        for (; hits; hits &= hits - 1)
+        {
+            const uint32_t i = __builtin_ctzll(hits);
+            // A key repeated in the burst is only deleted once
+            auto *entry = static_cast<Entry *>(entries[i]);
+            if (rte_hash_del_key_with_hash(m_Hash, &keys[i], entry->hash) < 0)
+                continue;
+
+            stopTimer(entry);
+            entry->value.~TValue();
+            rte_mempool_put(m_Mempool, entry);
+            ++erased;
+        }
+
+        return erased;
+    }
+
     std::size_t size() const noexcept
     {
         return rte_hash_count(m_Hash);
@@ -262,7 +491,7 @@ class AgingHashMap
         while (rte_hash_iterate(m_Hash, &key, &value, &next) >= 0)
         {
             auto *entry = static_cast<Entry *>(value);
-            rte_timer_stop(&entry->timer);
+            stopTimer(entry);
             entry->value.~TValue();
             rte_mempool_put(m_Mempool, entry);
         }
@@ -270,16 +499,133 @@ class AgingHashMap
     }
 
   private:
+    template <bool ExtendTTL>
+    int lookupBulk(const TKey *keys, const hash_sig_t *hashes, const uint32_t n, TValue **values,
+                   uint64_t *hitMask) const noexcept
+    {
+        const void *keyPtrs[RTE_HASH_LOOKUP_BULK_MAX];
+        void *entries[RTE_HASH_LOOKUP_BULK_MAX];
+        uint64_t hits = 0;
+
+        if (n == 0 || n > RTE_HASH_LOOKUP_BULK_MAX)
+            return -EINVAL;
+
+        for (uint32_t i = 0; i < n; ++i)
+            keyPtrs[i] = &keys[i];
+
+        const int hitsCount =
+            hashes ? rte_hash_lookup_with_hash_bulk_data(m_Hash, keyPtrs, const_cast<hash_sig_t *>(hashes), n, &hits,
+                                                         entries)
+                   : rte_hash_lookup_bulk_data(m_Hash, keyPtrs, n, &hits, entries);
+        if (hitsCount < 0)
+            return hitsCount;
+
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (hits & (1ULL << i))
+            {
+                auto *entry = static_cast<Entry *>(entries[i]);
+                if constexpr (ExtendTTL)
+                    scheduleTimer(entry);
+                values[i] = &entry->value;
+            }
+            else
+            {
+                values[i] = nullptr;
+            }
+        }
+
+        if (hitMask)
+            *hitMask = hits;
+        return hitsCount;
+    }
+
+    /// Timestamp ordering entries by last use: the deadline in TimerWheel mode, the last access in
+    /// LazyRteTimer mode and the timer expiry in RteTimer mode
+    static uint64_t lastUse(const Entry *entry) noexcept
+    {
+        if constexpr (USE_TIMER_WHEEL)
+            return TimerWheel::deadline(entry);
+        else if constexpr (USE_LAZY_RTE_TIMER)
+            return entry->lastAccess;
+        else
+            return entry->timer.expire;
+    }
+
+    /// Evicts the least recently used of m_EvictionSampleSize entries, walked from a random position. The
+    /// expire function is notified but cannot keep the victim.
+    bool evict()
+    {
+        const void *key = nullptr;
+        void *value = nullptr;
+        uint32_t next = static_cast<uint32_t>(rte_rand_max(Capacity));
+        bool wrapped = false;
+        Entry *victim = nullptr;
+
+        for (uint32_t sampled = 0; sampled < m_EvictionSampleSize;)
+        {
+            if (rte_hash_iterate(m_Hash, &key, &value, &next) < 0)
+            {
+                if (wrapped)
+                    break;
+                wrapped = true;
+                next = 0;
+                continue;
+            }
+
+            auto *entry = static_cast<Entry *>(value);
+            if (victim == nullptr || lastUse(entry) < lastUse(victim))
+                victim = entry;
+            ++sampled;
+        }
+
+        if (victim == nullptr || rte_hash_del_key_with_hash(m_Hash, &victim->key, victim->hash) < 0)
+        {
+            ++m_EvictionStats.mEvictionMisses;
+            return false;
+        }
+
+        if constexpr (!std::is_void<ExpireFn>::value)
+            m_ExpireFunction(victim->key, victim->value);
+
+        stopTimer(victim);
+        victim->value.~TValue();
+        rte_mempool_put(m_Mempool, victim);
+        ++m_EvictionStats.mEvictions;
+        return true;
+    }
+
     static void expire_cb(rte_timer *expired_timer, void *arg)
     {
-        auto *entry = static_cast<Entry *>(arg);
+        expire(static_cast<Entry *>(arg));
+    }
+
+    /// The expire function may keep the entry by returning false. In TimerWheel and LazyRteTimer modes the
+    /// entry is then kept for another TTL period, since a touch does not arm its timer. In RteTimer mode it
+    /// stays unarmed until its next touch.
+    static void expire(Entry *entry)
+    {
+        if constexpr (USE_LAZY_RTE_TIMER)
+        {
+            // Touched since the timer was armed: re-arm for the remaining time instead of expiring
+            const uint64_t now = rte_get_timer_cycles();
+            const uint64_t deadline = entry->lastAccess + entry->parent->m_TtlTicks;
+            if (deadline > now)
+            {
+                entry->parent->resetTimer(entry, deadline - now);
+                return;
+            }
+        }
+
         bool to_erase = true;
 
         if constexpr (!std::is_void<ExpireFn>::value)
             to_erase = entry->parent->m_ExpireFunction(entry->key, entry->value);
 
         if (to_erase)
-            entry->parent->erase(entry->key);
+            entry->parent->erase_with_hash(entry->key, entry->hash);
+        else if constexpr (USE_TIMER_WHEEL || USE_LAZY_RTE_TIMER)
+            entry->parent->armTimer(entry);
     }
 
     void init(const std::string &base_name)
@@ -287,7 +633,14 @@ class AgingHashMap
         const std::string poolName = base_name + "_mp";
         const std::string tableName = base_name + "_ht";
 
-        if (rte_timer_subsystem_init() < 0)
+        if constexpr (USE_TIMER_WHEEL)
+        {
+            const uint64_t tickCycles = rte_get_timer_hz() / TIMER_WHEEL_TICKS_PER_SEC;
+            const uint64_t ttlSlots = m_TtlTicks / tickCycles + 1;
+            m_TimerWheel.init(tickCycles, ttlSlots > TIMER_WHEEL_MIN_SLOTS ? ttlSlots : TIMER_WHEEL_MIN_SLOTS,
+                              rte_get_timer_cycles());
+        }
+        else if (const int ret = rte_timer_subsystem_init(); ret < 0 && ret != -EALREADY) // one per process
             throw std::runtime_error("rte_timer_subsystem_init failed");
 
         // 1) create mempool for Entry objects
@@ -302,7 +655,7 @@ class AgingHashMap
             .entries = Capacity,
             .reserved = 0,
             .key_len = sizeof(TKey),
-            .hash_func = rte_jhash,
+            .hash_func = &HashPolicy::hash,
             .hash_func_init_val = 0,
             .socket_id = m_SocketId,
             .extra_flag = ExtraFlags,
@@ -316,14 +669,57 @@ class AgingHashMap
         }
     }
 
+    void initTimer(Entry *entry)
+    {
+        if constexpr (USE_TIMER_WHEEL)
+            new (static_cast<TimerWheel::Node *>(entry)) TimerWheel::Node();
+        else
+            rte_timer_init(&entry->timer);
+    }
+
+    /// Starts the TTL of a new entry
+    void armTimer(Entry *entry)
+    {
+        if constexpr (USE_TIMER_WHEEL)
+        {
+            m_TimerWheel.schedule(entry, m_TimerWheel.now() + m_TtlTicks);
+        }
+        else
+        {
+            if constexpr (USE_LAZY_RTE_TIMER)
+                entry->lastAccess = m_CoarseNow;
+            resetTimer(entry, m_TtlTicks);
+        }
+    }
+
+    /// Restarts the TTL of a live entry
     void scheduleTimer(Entry *entry) const
+    {
+        // Lazy modes only store the coarse time of the last manageTimers() call
+        if constexpr (USE_TIMER_WHEEL)
+            TimerWheel::touch(entry, m_TimerWheel.now() + m_TtlTicks);
+        else if constexpr (USE_LAZY_RTE_TIMER)
+            entry->lastAccess = m_CoarseNow;
+        else
+            resetTimer(entry, m_TtlTicks);
+    }
+
+    static void resetTimer(Entry *entry, const uint64_t ticks)
     {
         const uint32_t lcore = rte_lcore_id();
-        rte_timer_reset(&entry->timer, m_TtlTicks,
+        rte_timer_reset(&entry->timer, ticks,
                         SINGLE, // one-shot
                         lcore, &AgingHashMap::expire_cb, entry);
     }
 
+    void stopTimer(Entry *entry)
+    {
+        if constexpr (USE_TIMER_WHEEL)
+            TimerWheel::cancel(entry);
+        else
+            rte_timer_stop(&entry->timer);
+    }
+
     /// After a move, update each Entry’s parent pointer to `this`
     void reassignParents()
     {
@@ -0,0 +1,257 @@
+#pragma once
+#include "ClassifierRule.hpp"
+#include "DirectTable.hpp"
+#include "IntervalTable.hpp"
+#include "PrefixTrie.hpp"
+#include "Common/Bitmap/AggregatedBitset.hpp"
+#include "Common/Bitmap/BitsetPool.hpp"
+#include "FlowTable/FiveTuple.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Footprint of a compiled Classifier
+class ClassifierMemoryReport
+{
+  public:
+    size_t mLeavesCount;         // bitset references held by the field structures
+    size_t mBitsetsCount;        // distinct bitsets among them
+    size_t mBitsetBytes;         // bytes of the distinct bitsets
+    size_t mUnsharedBitsetBytes; // bytes the leaves would take with a private copy each
+    size_t mStructureBytes;      // tries, interval tables and direct tables
+};
+
+/// Bit-vector packet classifier. Each header field has a lookup structure that maps the field value to
+/// the precomputed set of rules that field matches: a stride-8 trie for each address, an elementary
+/// interval table for each port and a direct table for the protocol and the TCP flags. Classifying a
+/// packet is six lookups and one intersection of the six rule bitsets, through the aggregated kernels
+/// that only visit the 512-rule blocks every field has in common.
+/// Rule i has priority i: the lower the index, the higher the priority. The rule bitsets are built once
+/// by the constructor, the rule compiler, and are read-only afterwards, so lookups are safe from any
+/// number of lcores.
+/// Most leaves of the field structures match one of a few rule subsets, so the compiler hash-conses
+/// their bitsets in a refcounted BitsetPool: equal leaves point at one canonical copy. Classifiers built
+/// on the same pool, such as the current and the next rule set, share their common bitsets too.
+template <size_t MAX_RULES = 65536>
+class Classifier
+{
+  public:
+    using RuleBitset = AggregatedBitset<MAX_RULES>;
+
+    enum class Field : uint8_t
+    {
+        SourceAddress = 0,
+        DestinationAddress,
+        SourcePort,
+        DestinationPort,
+        Protocol,
+        TcpFlags,
+    };
+
+    static constexpr size_t FIELDS_COUNT = 6;
+    static constexpr size_t NO_MATCH = RuleBitset::NO_MATCH;
+
+    using FieldBitsets = std::array<const RuleBitset *, FIELDS_COUNT>;
+    using RuleBitsetPool = BitsetPool<RuleBitset>;
+
+  private:
+    size_t m_RulesCount;
+    std::shared_ptr<RuleBitsetPool> m_Pool;
+    std::vector<const RuleBitset *> m_Leaves; // one pool reference per leaf the structures point at
+    PrefixTrie<RuleBitset> m_SourceAddresses;
+    PrefixTrie<RuleBitset> m_DestinationAddresses;
+    IntervalTable<RuleBitset> m_SourcePorts;
+    IntervalTable<RuleBitset> m_DestinationPorts;
+    DirectTable<RuleBitset> m_Protocols;
+    DirectTable<RuleBitset> m_TcpFlags;
+
+  public:
+    /// @param pool pool the rule bitsets are shared through, a private one if null
+    explicit Classifier(const std::vector<ClassifierRule> &rules, std::shared_ptr<RuleBitsetPool> pool = nullptr)
+        : m_RulesCount(rules.size()), m_Pool(pool ? std::move(pool) : std::make_shared<RuleBitsetPool>())
+    {
+        if (rules.size() > MAX_RULES)
+            throw std::invalid_argument("Classifier holds at most MAX_RULES rules");
+        for (const ClassifierRule &rule : rules)
+        {
+            if (rule.mSourcePrefixLength > 32 || rule.mDestinationPrefixLength > 32 ||
+                rule.mSourcePortLow > rule.mSourcePortHigh || rule.mDestinationPortLow > rule.mDestinationPortHigh)
+                throw std::invalid_argument("Classifier rule with an invalid prefix or port range");
+        }
+
+        try
+        {
+            compilePrefixes(rules, &ClassifierRule::mSourceAddress, &ClassifierRule::mSourcePrefixLength,
+                            m_SourceAddresses);
+            compilePrefixes(rules, &ClassifierRule::mDestinationAddress,
+                            &ClassifierRule::mDestinationPrefixLength, m_DestinationAddresses);
+            compileRanges(rules, &ClassifierRule::mSourcePortLow, &ClassifierRule::mSourcePortHigh, m_SourcePorts);
+            compileRanges(rules, &ClassifierRule::mDestinationPortLow, &ClassifierRule::mDestinationPortHigh,
+                          m_DestinationPorts);
+            compileMasked(rules, &ClassifierRule::mProtocol, &ClassifierRule::mProtocolMask, m_Protocols);
+            compileMasked(rules, &ClassifierRule::mTcpFlags, &ClassifierRule::mTcpFlagsMask, m_TcpFlags);
+        }
+        catch (...)
+        {
+            releaseLeaves(); // the pool may outlive this half-built classifier
+            throw;
+        }
+    }
+    ~Classifier()
+    {
+        releaseLeaves();
+    }
+
+    // Deleted copy constructor and assignment operator
+    Classifier(const Classifier &) = delete;
+    Classifier &operator=(const Classifier &) = delete;
+
+    /// Rule bitsets each field of the packet matches, indexed by Field
+    FieldBitsets lookup(const FiveTuple &fiveTuple, const uint8_t tcpFlags = 0) const noexcept
+    {
+        return {m_SourceAddresses.lookup(fiveTuple.mSourceAddress),
+                m_DestinationAddresses.lookup(fiveTuple.mDestinationAddress),
+                m_SourcePorts.lookup(fiveTuple.mSourcePort),
+                m_DestinationPorts.lookup(fiveTuple.mDestinationPort),
+                m_Protocols.lookup(fiveTuple.mProtocol),
+                m_TcpFlags.lookup(tcpFlags)};
+    }
+
+    /// @return highest priority rule matching the packet, NO_MATCH if there is none
+    size_t classify(const FiveTuple &fiveTuple, const uint8_t tcpFlags = 0) const noexcept
+    {
+        const FieldBitsets rows = lookup(fiveTuple, tcpFlags);
+        return RuleBitset::OperateANDFirst(rows.data(), FIELDS_COUNT);
+    }
+
+    /// Writes the `k` highest priority rules matching the packet to `ids`, by decreasing priority
+    /// @return number of ids written
+    size_t classify(const FiveTuple &fiveTuple, const uint8_t tcpFlags, uint32_t *ids, const size_t k) const noexcept
+    {
+        const FieldBitsets rows = lookup(fiveTuple, tcpFlags);
+        return RuleBitset::OperateANDTopK(rows.data(), FIELDS_COUNT, ids, k);
+    }
+
+    size_t rulesCount() const noexcept
+    {
+        return m_RulesCount;
+    }
+
+    const RuleBitsetPool &pool() const noexcept
+    {
+        return *m_Pool;
+    }
+
+    ClassifierMemoryReport memoryReport() const
+    {
+        std::vector<const RuleBitset *> distinct(m_Leaves);
+        std::sort(distinct.begin(), distinct.end());
+        const size_t bitsetsCount = std::unique(distinct.begin(), distinct.end()) - distinct.begin();
+
+        return ClassifierMemoryReport{
+            m_Leaves.size(),
+            bitsetsCount,
+            bitsetsCount * sizeof(RuleBitset),
+            m_Leaves.size() * sizeof(RuleBitset),
+            m_SourceAddresses.memoryBytes() + m_DestinationAddresses.memoryBytes() + m_SourcePorts.memoryBytes() +
+                m_DestinationPorts.memoryBytes() + sizeof(m_Protocols) + sizeof(m_TcpFlags)};
+    }
+
+  private:
+    /// @return canonical copy of `bits` in the pool, referenced until the classifier goes away
+    const RuleBitset *store(const RuleBitset &bits)
+    {
+        if (m_Leaves.size() == m_Leaves.capacity()) // grow first, so an acquired reference is never lost
+            m_Leaves.reserve(2 * m_Leaves.size() + 64);
+        m_Leaves.push_back(m_Pool->acquire(bits));
+        return m_Leaves.back();
+    }
+
+    void releaseLeaves() noexcept
+    {
+        for (const RuleBitset *leaf : m_Leaves)
+            m_Pool->release(leaf);
+        m_Leaves.clear();
+    }
+
+    /// Shortest prefixes first, so the rules of every prefix are added to those of the longest prefix
+    /// covering it, already in the trie; each trie entry then holds all the rules its addresses match.
+    void compilePrefixes(const std::vector<ClassifierRule> &rules, uint32_t ClassifierRule::*address,
+                         uint8_t ClassifierRule::*length, PrefixTrie<RuleBitset> &trie)
+    {
+        std::map<std::pair<uint8_t, uint32_t>, std::vector<uint32_t>> prefixes;
+        for (uint32_t rule = 0; rule < rules.size(); ++rule)
+        {
+            const uint8_t prefixLength = rules[rule].*length;
+            const uint32_t mask = prefixLength ? ~0u << (32 - prefixLength) : 0;
+            prefixes[{prefixLength, rules[rule].*address & mask}].push_back(rule);
+        }
+
+        auto bits = std::make_unique<RuleBitset>();
+        trie = PrefixTrie<RuleBitset>(store(*bits));
+        for (const auto &[prefix, prefixRules] : prefixes)
+        {
+            *bits = *trie.lookup(prefix.second);
+            for (const uint32_t rule : prefixRules)
+                bits->set(rule);
+            trie.insert(prefix.second, prefix.first, store(*bits));
+        }
+    }
+
+    /// Sweeps the range endpoints in order: a rule enters the current set at its low end and leaves it
+    /// right after its high end, and every endpoint opens an elementary interval with the current set.
+    void compileRanges(const std::vector<ClassifierRule> &rules, uint16_t ClassifierRule::*low,
+                       uint16_t ClassifierRule::*high, IntervalTable<RuleBitset> &table)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> endpoints; // (position, rule << 1 | entering)
+        for (uint32_t rule = 0; rule < rules.size(); ++rule)
+        {
+            endpoints.emplace_back(rules[rule].*low, rule << 1 | 1);
+            if (rules[rule].*high < UINT16_MAX)
+                endpoints.emplace_back(rules[rule].*high + 1u, rule << 1);
+        }
+        std::sort(endpoints.begin(), endpoints.end());
+
+        auto bits = std::make_unique<RuleBitset>();
+        const RuleBitset *current = nullptr;
+        table = IntervalTable<RuleBitset>();
+        for (size_t endpoint = 0, position = 0;;)
+        {
+            for (; endpoint < endpoints.size() && endpoints[endpoint].first == position; ++endpoint)
+                bits->set(endpoints[endpoint].second >> 1, endpoints[endpoint].second & 1);
+            if (current == nullptr || *current != *bits)
+                current = store(*bits);
+            table.append(static_cast<uint16_t>(position), current);
+
+            if (endpoint == endpoints.size())
+                break;
+            position = endpoints[endpoint].first;
+        }
+    }
+
+    /// Evaluates every rule against each of the 256 keys. Runs of keys with the same rules skip the pool.
+    void compileMasked(const std::vector<ClassifierRule> &rules, uint8_t ClassifierRule::*value,
+                       uint8_t ClassifierRule::*mask, DirectTable<RuleBitset> &table)
+    {
+        auto bits = std::make_unique<RuleBitset>();
+        const RuleBitset *current = nullptr;
+        for (size_t key = 0; key < DirectTable<RuleBitset>::KEYS_COUNT; ++key)
+        {
+            bits->reset();
+            for (uint32_t rule = 0; rule < rules.size(); ++rule)
+            {
+                if (((key ^ rules[rule].*value) & rules[rule].*mask) == 0)
+                    bits->set(rule);
+            }
+            if (current == nullptr || *current != *bits)
+                current = store(*bits);
+            table.set(static_cast<uint8_t>(key), current);
+        }
+    }
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+
+/// Match conditions of a rule. Addresses and ports use the same host-order values as FiveTuple, and a
+/// default-constructed rule matches every packet. A packet matches when:
+///   - its addresses fall in the prefixes (a length of 0 is a wildcard),
+///   - its ports fall in the inclusive ranges,
+///   - (protocol & mProtocolMask) == (mProtocol & mProtocolMask), a mask of 0 being a wildcard,
+///   - (tcpFlags & mTcpFlagsMask) == (mTcpFlags & mTcpFlagsMask), with the flags of non-TCP packets 0.
+class ClassifierRule
+{
+  public:
+    uint32_t mSourceAddress{0};
+    uint32_t mDestinationAddress{0};
+    uint8_t mSourcePrefixLength{0};
+    uint8_t mDestinationPrefixLength{0};
+    uint16_t mSourcePortLow{0};
+    uint16_t mSourcePortHigh{UINT16_MAX};
+    uint16_t mDestinationPortLow{0};
+    uint16_t mDestinationPortHigh{UINT16_MAX};
+    uint8_t mProtocol{0};
+    uint8_t mProtocolMask{0};
+    uint8_t mTcpFlags{0};
+    uint8_t mTcpFlagsMask{0};
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// One value per possible 8-bit key, for fields narrow enough to index directly: the protocol and the
+/// TCP flags. Values are not owned.
+template <typename T>
+class DirectTable
+{
+  public:
+    static constexpr size_t KEYS_COUNT = 256;
+
+  private:
+    std::array<const T *, KEYS_COUNT> m_Values{};
+
+  public:
+    DirectTable() = default;
+    ~DirectTable() = default;
+
+    void set(const uint8_t key, const T *value) noexcept
+    {
+        m_Values[key] = value;
+    }
+
+    const T *lookup(const uint8_t key) const noexcept
+    {
+        return m_Values[key];
+    }
+};
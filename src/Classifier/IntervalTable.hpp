@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Elementary-interval table over 16-bit keys such as ports. The endpoints of all the ranges cut the key
+/// space into intervals inside which every key matches the same ranges; the table keeps the sorted
+/// interval starts and one value per interval, and a lookup is a binary search over the starts.
+/// Neighbouring intervals with the same value are merged. Values are not owned.
+template <typename T>
+class IntervalTable
+{
+  private:
+    std::vector<uint16_t> m_Starts;
+    std::vector<const T *> m_Values;
+
+  public:
+    IntervalTable() = default;
+    ~IntervalTable() = default;
+
+    /// Opens an interval at `start` that runs up to the next one. Starts must be increasing and the
+    /// first one must be 0, so every key falls in an interval.
+    void append(const uint16_t start, const T *value)
+    {
+        assert(m_Starts.empty() ? start == 0 : start > m_Starts.back());
+        if (!m_Values.empty() && m_Values.back() == value)
+            return;
+        m_Starts.push_back(start);
+        m_Values.push_back(value);
+    }
+
+    const T *lookup(const uint16_t key) const noexcept
+    {
+        assert(!m_Starts.empty());
+        const auto next = std::upper_bound(m_Starts.begin(), m_Starts.end(), key);
+        return m_Values[(next - m_Starts.begin()) - 1];
+    }
+
+    size_t intervalsCount() const noexcept
+    {
+        return m_Starts.size();
+    }
+
+    size_t memoryBytes() const noexcept
+    {
+        return m_Starts.capacity() * sizeof(uint16_t) + m_Values.capacity() * sizeof(const T *);
+    }
+};
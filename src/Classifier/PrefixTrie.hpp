@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Longest-prefix-match trie over IPv4 addresses with a fixed 8-bit stride, so a lookup reads at most
+/// four nodes. Prefixes are expanded into the entries of their level (controlled prefix expansion) and
+/// a node created under an entry starts as 256 copies of that entry's value, so the value found at the
+/// deepest node reached is the one of the longest matching prefix. Values are not owned.
+template <typename T>
+class PrefixTrie
+{
+  public:
+    static constexpr uint8_t STRIDE = 8;
+    static constexpr uint8_t LEVELS_COUNT = 32 / STRIDE;
+
+  private:
+    static constexpr size_t FANOUT = 1u << STRIDE;
+    static constexpr uint32_t NO_CHILD = 0; // the root is never a child
+
+    class Node
+    {
+      public:
+        std::array<const T *, FANOUT> mValues;
+        std::array<uint32_t, FANOUT> mChildren;
+    };
+
+    std::vector<Node> m_Nodes;
+    uint8_t m_LastPrefixLength{0};
+
+  public:
+    /// @param defaultValue value of the /0 prefix, found by addresses no other prefix matches
+    explicit PrefixTrie(const T *defaultValue = nullptr)
+        : m_Nodes(1)
+    {
+        m_Nodes[0].mValues.fill(defaultValue);
+        m_Nodes[0].mChildren.fill(NO_CHILD);
+    }
+    ~PrefixTrie() = default;
+
+    /// Binds `value` to address/length. Prefixes must come by non-decreasing length, so a shorter prefix
+    /// never has to be pushed under nodes a longer one created; a /0 replaces the default value.
+    void insert(const uint32_t address, const uint8_t length, const T *value)
+    {
+        assert(length <= 32 && length >= m_LastPrefixLength);
+        m_LastPrefixLength = length;
+
+        if (length == 0)
+        {
+            m_Nodes[0].mValues.fill(value);
+            return;
+        }
+
+        const uint8_t level = (length - 1) / STRIDE;
+        uint32_t node = 0;
+        for (uint8_t depth = 0; depth < level; ++depth)
+            node = child(node, chunk(address, depth));
+
+        const uint32_t span = 1u << ((level + 1) * STRIDE - length);
+        const uint32_t first = chunk(address, level) & ~(span - 1);
+        for (uint32_t entry = first; entry < first + span; ++entry)
+        {
+            assert(m_Nodes[node].mChildren[entry] == NO_CHILD);
+            m_Nodes[node].mValues[entry] = value;
+        }
+    }
+
+    /// @return value of the longest prefix matching `address`
+    const T *lookup(const uint32_t address) const noexcept
+    {
+        const Node *node = &m_Nodes[0];
+        for (uint8_t depth = 0;; ++depth)
+        {
+            const uint8_t entry = chunk(address, depth);
+            if (depth == LEVELS_COUNT - 1 || node->mChildren[entry] == NO_CHILD)
+                return node->mValues[entry];
+            node = &m_Nodes[node->mChildren[entry]];
+        }
+    }
+
+    size_t nodesCount() const noexcept
+    {
+        return m_Nodes.size();
+    }
+
+    size_t memoryBytes() const noexcept
+    {
+        return m_Nodes.capacity() * sizeof(Node);
+    }
+
+  private:
+    static uint8_t chunk(const uint32_t address, const uint8_t depth) noexcept
+    {
+        return static_cast<uint8_t>(address >> (32 - (depth + 1) * STRIDE));
+    }
+
+    uint32_t child(const uint32_t node, const uint8_t entry)
+    {
+        if (m_Nodes[node].mChildren[entry] == NO_CHILD)
+        {
+            const T *inherited = m_Nodes[node].mValues[entry];
+            const uint32_t created = static_cast<uint32_t>(m_Nodes.size());
+            m_Nodes.emplace_back(); // may move the nodes, index them again below
+            m_Nodes[created].mValues.fill(inherited);
+            m_Nodes[created].mChildren.fill(NO_CHILD);
+            m_Nodes[node].mChildren[entry] = created;
+        }
+        return m_Nodes[node].mChildren[entry];
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include "AggregatedBitset.hpp"
+#include <array>
+
+/// Bitmap of H aggregated bitsets, with the Bitmap interface. Intersections skip every 512-bit block
+/// that is empty in any row, which pays off when the rows are sparse.
+template <size_t W, size_t H>
+class AggregatedBitmap
+{
+    static_assert(H <= AggregatedBitset<W>::MAX_ROWS, "Too many rows for an aggregated intersection");
+
+  private:
+    using BitsetDataType = AggregatedBitset<W>;
+    using BitmapDataType = std::array<BitsetDataType, H>;
+
+  public:
+    static constexpr size_t NO_MATCH = W;
+    static constexpr size_t TOP_K_MAX = 16;
+
+    AggregatedBitmap() = default;
+    ~AggregatedBitmap() = default;
+
+    // Deleted copy constructor and assignment operator
+    AggregatedBitmap(const AggregatedBitmap &) = delete;
+    AggregatedBitmap &operator=(const AggregatedBitmap &) = delete;
+
+    // Defaulted move constructor and assignment operator
+    AggregatedBitmap(AggregatedBitmap &&) noexcept = default;
+    AggregatedBitmap &operator=(AggregatedBitmap &&) noexcept = default;
+
+    // Accessors
+    inline BitmapDataType &getData()
+    {
+        return m_Data;
+    }
+    const BitmapDataType &getData() const
+    {
+        return m_Data;
+    }
+
+    BitsetDataType OperateAND() const;
+    size_t OperateANDFirst() const;
+    size_t OperateANDTopK(uint32_t *ids, size_t k) const;
+
+  private:
+    std::array<const BitsetDataType *, H> rows() const noexcept;
+
+    BitmapDataType m_Data;
+};
+
+template <size_t W, size_t H>
+std::array<const typename AggregatedBitmap<W, H>::BitsetDataType *, H> AggregatedBitmap<W, H>::rows() const noexcept
+{
+    std::array<const BitsetDataType *, H> rows;
+    for (size_t row = 0; row < H; ++row)
+        rows[row] = &m_Data[row];
+    return rows;
+}
+
+template <size_t W, size_t H>
+typename AggregatedBitmap<W, H>::BitsetDataType AggregatedBitmap<W, H>::OperateAND() const
+{
+    BitsetDataType result;
+    BitsetDataType::OperateAND(rows().data(), H, result);
+    return result;
+}
+
+template <size_t W, size_t H>
+size_t AggregatedBitmap<W, H>::OperateANDFirst() const
+{
+    return BitsetDataType::OperateANDFirst(rows().data(), H);
+}
+
+template <size_t W, size_t H>
+size_t AggregatedBitmap<W, H>::OperateANDTopK(uint32_t *ids, const size_t k) const
+{
+    return BitsetDataType::OperateANDTopK(rows().data(), H, ids, k);
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include "Bitset.hpp"
+#include "BitsetKernels.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/// Two-level bitset: the bits, plus a summary with one bit per 512-bit block telling whether the block
+/// has any bit set. Intersections AND the summaries first and only visit the blocks set in every row,
+/// so sparse rule sets cost a few summary words instead of a full scan. A 65536-bit set has a 2-word
+/// summary.
+template <size_t W>
+class alignas(64) AggregatedBitset
+{
+  public:
+    static constexpr size_t BLOCK_BITS = BitsetKernels::BLOCK_WORDS * 64;
+    static constexpr size_t BLOCKS_COUNT = (W + BLOCK_BITS - 1) / BLOCK_BITS;
+    static constexpr size_t SUMMARY_WORDS = (BLOCKS_COUNT + 63) / 64;
+    static constexpr size_t NO_MATCH = W;
+    static constexpr size_t MAX_ROWS = 64; // rows an intersection takes
+
+  private:
+    Bitset<W> m_Bits;
+    std::array<uint64_t, SUMMARY_WORDS> m_Summary{};
+
+  public:
+    AggregatedBitset() = default;
+    explicit AggregatedBitset(const Bitset<W> &bits)
+        : m_Bits(bits)
+    {
+        rebuildSummary();
+    }
+    ~AggregatedBitset() = default;
+
+    static constexpr size_t size() noexcept
+    {
+        return W;
+    }
+
+    const Bitset<W> &bits() const noexcept
+    {
+        return m_Bits;
+    }
+
+    /// Writing through data() leaves the summary stale until rebuildSummary()
+    uint64_t *data() noexcept
+    {
+        return m_Bits.data();
+    }
+    const uint64_t *data() const noexcept
+    {
+        return m_Bits.data();
+    }
+
+    const uint64_t *summary() const noexcept
+    {
+        return m_Summary.data();
+    }
+
+    bool blockAny(const size_t block) const noexcept
+    {
+        return (m_Summary[block / 64] >> (block % 64)) & 1;
+    }
+
+    void rebuildSummary() noexcept
+    {
+        m_Summary.fill(0);
+        for (size_t block = 0; block < BLOCKS_COUNT; ++block)
+            updateSummary(block);
+    }
+
+    AggregatedBitset &set(const size_t pos, const bool value = true) noexcept
+    {
+        m_Bits.set(pos, value);
+        updateSummary(pos / BLOCK_BITS);
+        return *this;
+    }
+
+    AggregatedBitset &reset(const size_t pos) noexcept
+    {
+        return set(pos, false);
+    }
+
+    AggregatedBitset &reset() noexcept
+    {
+        m_Bits.reset();
+        m_Summary.fill(0);
+        return *this;
+    }
+
+    bool test(const size_t pos) const noexcept
+    {
+        return m_Bits.test(pos);
+    }
+
+    size_t count() const noexcept
+    {
+        return m_Bits.count();
+    }
+
+    bool any() const noexcept
+    {
+        uint64_t blocks = 0;
+        for (const uint64_t word : m_Summary)
+            blocks |= word;
+        return blocks != 0;
+    }
+
+    bool none() const noexcept
+    {
+        return !any();
+    }
+
+    /// A block of the union is set when it is set in either operand, so the summaries just OR too
+    AggregatedBitset &operator|=(const AggregatedBitset &other) noexcept
+    {
+        m_Bits |= other.m_Bits;
+        for (size_t i = 0; i < SUMMARY_WORDS; ++i)
+            m_Summary[i] |= other.m_Summary[i];
+        return *this;
+    }
+
+    bool operator==(const AggregatedBitset &other) const noexcept
+    {
+        return m_Bits == other.m_Bits;
+    }
+
+    bool operator!=(const AggregatedBitset &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    /// Intersection of up to MAX_ROWS bitsets, only the blocks set in every summary are read. More rows
+    /// throw std::invalid_argument.
+    static void OperateAND(const AggregatedBitset *const *rows, const size_t rowsCount, AggregatedBitset &result)
+    {
+        result.reset();
+        if (rowsCount == 0)
+        {
+            result.m_Bits.set();
+            result.rebuildSummary();
+            return;
+        }
+
+        const BitsetKernels::AndFunction andFunction = BitsetKernels::andFunction();
+        forEachCommonBlock(rows, rowsCount, [&](const size_t block, const uint64_t *const *blockRows) {
+            andFunction(result.data() + block * BitsetKernels::BLOCK_WORDS, blockRows, rowsCount,
+                        blockWords(block));
+            result.updateSummary(block);
+            return true;
+        });
+    }
+
+    /// Fused intersection and extraction of the first `k` common bits of up to MAX_ROWS bitsets, in
+    /// increasing order
+    /// @return number of ids written, std::invalid_argument is thrown past MAX_ROWS rows
+    static size_t OperateANDTopK(const AggregatedBitset *const *rows, const size_t rowsCount, uint32_t *ids,
+                                 const size_t k)
+    {
+        size_t found = 0;
+        if (rowsCount == 0)
+        {
+            for (; found < k && found < W; ++found)
+                ids[found] = static_cast<uint32_t>(found);
+            return found;
+        }
+
+        const BitsetKernels::MatchFunction matchFunction = BitsetKernels::matchFunction();
+        forEachCommonBlock(rows, rowsCount, [&](const size_t block, const uint64_t *const *blockRows) {
+            const size_t blockFound = matchFunction(blockRows, rowsCount, blockWords(block), ids + found, k - found);
+            for (size_t i = found; i < found + blockFound; ++i)
+                ids[i] += static_cast<uint32_t>(block * BLOCK_BITS);
+            found += blockFound;
+            return found < k;
+        });
+        return found;
+    }
+
+    /// @return index of the first common bit, NO_MATCH if there is none
+    static size_t OperateANDFirst(const AggregatedBitset *const *rows, const size_t rowsCount)
+    {
+        uint32_t id;
+        return OperateANDTopK(rows, rowsCount, &id, 1) ? id : NO_MATCH;
+    }
+
+  private:
+    static constexpr size_t blockWords(const size_t block) noexcept
+    {
+        return (block + 1) * BitsetKernels::BLOCK_WORDS <= Bitset<W>::WORDS_COUNT
+                   ? BitsetKernels::BLOCK_WORDS
+                   : Bitset<W>::WORDS_COUNT - block * BitsetKernels::BLOCK_WORDS;
+    }
+
+    void updateSummary(const size_t block) noexcept
+    {
+        uint64_t blockBits = 0;
+        const uint64_t *words = m_Bits.data() + block * BitsetKernels::BLOCK_WORDS;
+        for (size_t i = 0; i < blockWords(block); ++i)
+            blockBits |= words[i];
+
+        const uint64_t mask = 1ULL << (block % 64);
+        m_Summary[block / 64] = blockBits ? (m_Summary[block / 64] | mask) : (m_Summary[block / 64] & ~mask);
+    }
+
+    /// Calls visit(block, blockRows) in increasing block order for every block set in all the summaries,
+    /// with blockRows pointing at that block of each row, until visit returns false
+    template <typename Visit>
+    static void forEachCommonBlock(const AggregatedBitset *const *rows, const size_t rowsCount, Visit &&visit)
+    {
+        // A hard check: blockRows is on the stack, release builds must not overflow it either
+        if (rowsCount > MAX_ROWS)
+            throw std::invalid_argument("AggregatedBitset intersects at most MAX_ROWS rows");
+        const uint64_t *blockRows[MAX_ROWS];
+
+        for (size_t summaryWord = 0; summaryWord < SUMMARY_WORDS; ++summaryWord)
+        {
+            uint64_t common = ~0ULL;
+            for (size_t row = 0; row < rowsCount && common != 0; ++row)
+                common &= rows[row]->m_Summary[summaryWord];
+
+            for (; common != 0; common &= common - 1)
+            {
+                const size_t block = summaryWord * 64 + __builtin_ctzll(common);
+                for (size_t row = 0; row < rowsCount; ++row)
+                    blockRows[row] = rows[row]->data() + block * BitsetKernels::BLOCK_WORDS;
+                if (!visit(block, blockRows))
+                    return;
+            }
+        }
+    }
+};
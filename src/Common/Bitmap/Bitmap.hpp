@@ -1,5 +1,6 @@
 #pragma once
 #include "Bitset.hpp"
+#include "BitsetKernels.hpp"
 #include <array>
 
 template <size_t W, size_t H>
@@ -10,6 +11,11 @@ class Bitmap
     using BitmapDataType = std::array<BitsetDataType, H>;
 
   public:
+    /// Returned by OperateANDFirst() when the rows have no bit in common
+    static constexpr size_t NO_MATCH = W;
+    /// Ids a TrackDescriptor holds, the usual bound of OperateANDTopK()
+    static constexpr size_t TOP_K_MAX = 16;
+
     Bitmap() = default;
     ~Bitmap() = default;
 
@@ -31,8 +37,28 @@ class Bitmap
         return m_Data;
     }
 
+    /// Intersection of the H rows, with the widest kernel the CPU supports
     BitsetDataType OperateAND() const;
 
+    /// Intersection of the H rows with a given kernel, which must be supported
+    BitsetDataType OperateAND(BitsetKernels::Kernel kernel) const;
+
+    /// Index of the first bit set in every row, the highest priority match when rules are ordered by bit
+    /// index. Fused with the intersection: the scan stops at the first non-zero block and the result is
+    /// never materialized.
+    /// @return NO_MATCH if the rows have no bit in common
+    size_t OperateANDFirst() const;
+    size_t OperateANDFirst(BitsetKernels::Kernel kernel) const;
+
+    /// Indexes of the first `k` bits set in every row, in increasing order
+    /// @return number of ids written, at most k
+    size_t OperateANDTopK(uint32_t *ids, size_t k) const;
+    size_t OperateANDTopK(uint32_t *ids, size_t k, BitsetKernels::Kernel kernel) const;
+
+  private:
+    BitsetDataType OperateAND(BitsetKernels::AndFunction andFunction) const;
+    size_t OperateANDTopK(uint32_t *ids, size_t k, BitsetKernels::MatchFunction matchFunction) const;
+
   private:
     BitmapDataType m_Data;
 };
@@ -40,11 +66,61 @@ class Bitmap
 template <size_t W, size_t H>
 typename Bitmap<W, H>::BitsetDataType Bitmap<W, H>::OperateAND() const
 {
+    return OperateAND(BitsetKernels::andFunction());
+}
+
+template <size_t W, size_t H>
+typename Bitmap<W, H>::BitsetDataType Bitmap<W, H>::OperateAND(const BitsetKernels::Kernel kernel) const
+{
+    return OperateAND(BitsetKernels::andFunction(kernel));
+}
+
+template <size_t W, size_t H>
+typename Bitmap<W, H>::BitsetDataType Bitmap<W, H>::OperateAND(const BitsetKernels::AndFunction andFunction) const
+{
+    const uint64_t *rows[H > 0 ? H : 1];
+    for (size_t row = 0; row < H; ++row)
+        rows[row] = m_Data[row].data();
+
+    // One pass over the result, every block is ANDed across all the rows before it is stored
     BitsetDataType result;
-    result.set(); // Initialize all bits to 1
-    for (const auto &bitset : m_Data)
-    {
-        result &= bitset;
-    }
+    andFunction(result.data(), rows, H, BitsetDataType::WORDS_COUNT);
     return result;
 }
+
+template <size_t W, size_t H>
+size_t Bitmap<W, H>::OperateANDFirst() const
+{
+    uint32_t id;
+    return OperateANDTopK(&id, 1, BitsetKernels::matchFunction()) ? id : NO_MATCH;
+}
+
+template <size_t W, size_t H>
+size_t Bitmap<W, H>::OperateANDFirst(const BitsetKernels::Kernel kernel) const
+{
+    uint32_t id;
+    return OperateANDTopK(&id, 1, BitsetKernels::matchFunction(kernel)) ? id : NO_MATCH;
+}
+
+template <size_t W, size_t H>
+size_t Bitmap<W, H>::OperateANDTopK(uint32_t *ids, const size_t k) const
+{
+    return OperateANDTopK(ids, k, BitsetKernels::matchFunction());
+}
+
+template <size_t W, size_t H>
+size_t Bitmap<W, H>::OperateANDTopK(uint32_t *ids, const size_t k, const BitsetKernels::Kernel kernel) const
+{
+    return OperateANDTopK(ids, k, BitsetKernels::matchFunction(kernel));
+}
+
+template <size_t W, size_t H>
+size_t Bitmap<W, H>::OperateANDTopK(uint32_t *ids, const size_t k,
+                                    const BitsetKernels::MatchFunction matchFunction) const
+{
+    const uint64_t *rows[H > 0 ? H : 1];
+    for (size_t row = 0; row < H; ++row)
+        rows[row] = m_Data[row].data();
+
+    return matchFunction(rows, H, BitsetDataType::WORDS_COUNT, ids, k);
+}
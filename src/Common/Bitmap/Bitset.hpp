@@ -1,5 +1,110 @@
 #pragma once
-#include <bitset>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
+/// Fixed-size bitset over a 64-byte aligned array of 64-bit words, so vector kernels can stream it with
+/// aligned loads. Bit i lives in bit (i % 64) of word i / 64. Mirrors the std::bitset members in use.
 template <size_t W>
-using Bitset = std::bitset<W>;
\ No newline at end of file
+class alignas(64) Bitset
+{
+    static_assert(W > 0 && W % 64 == 0, "Bitset width must be a multiple of 64 bits");
+
+  public:
+    static constexpr size_t WORDS_COUNT = W / 64;
+
+  private:
+    std::array<uint64_t, WORDS_COUNT> m_Words{};
+
+  public:
+    Bitset() = default;
+    ~Bitset() = default;
+
+    static constexpr size_t size() noexcept
+    {
+        return W;
+    }
+
+    uint64_t *data() noexcept
+    {
+        return m_Words.data();
+    }
+    const uint64_t *data() const noexcept
+    {
+        return m_Words.data();
+    }
+
+    Bitset &set() noexcept
+    {
+        m_Words.fill(~0ULL);
+        return *this;
+    }
+
+    Bitset &set(const size_t pos, const bool value = true) noexcept
+    {
+        const uint64_t mask = 1ULL << (pos % 64);
+        m_Words[pos / 64] = value ? (m_Words[pos / 64] | mask) : (m_Words[pos / 64] & ~mask);
+        return *this;
+    }
+
+    Bitset &reset() noexcept
+    {
+        m_Words.fill(0ULL);
+        return *this;
+    }
+
+    Bitset &reset(const size_t pos) noexcept
+    {
+        return set(pos, false);
+    }
+
+    bool test(const size_t pos) const noexcept
+    {
+        return (m_Words[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    size_t count() const noexcept
+    {
+        size_t bits = 0;
+        for (const uint64_t word : m_Words)
+            bits += __builtin_popcountll(word);
+        return bits;
+    }
+
+    bool any() const noexcept
+    {
+        uint64_t bits = 0;
+        for (const uint64_t word : m_Words)
+            bits |= word;
+        return bits != 0;
+    }
+
+    bool none() const noexcept
+    {
+        return !any();
+    }
+
+    Bitset &operator&=(const Bitset &other) noexcept
+    {
+        for (size_t i = 0; i < WORDS_COUNT; ++i)
+            m_Words[i] &= other.m_Words[i];
+        return *this;
+    }
+
+    Bitset &operator|=(const Bitset &other) noexcept
+    {
+        for (size_t i = 0; i < WORDS_COUNT; ++i)
+            m_Words[i] |= other.m_Words[i];
+        return *this;
+    }
+
+    bool operator==(const Bitset &other) const noexcept
+    {
+        return m_Words == other.m_Words;
+    }
+
+    bool operator!=(const Bitset &other) const noexcept
+    {
+        return !(*this == other);
+    }
+};
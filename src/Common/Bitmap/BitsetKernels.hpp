@@ -0,0 +1,335 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/// Intersection kernels over word arrays, one per instruction set. Every variant is compiled with its own
+/// target attribute, so the binary keeps the baseline ISA and the widest variant the CPU supports is
+/// picked at runtime.
+namespace BitsetKernels
+{
+    enum class Kernel : uint8_t
+    {
+        Scalar,
+        Sse2,
+        Avx2,
+        Avx512,
+    };
+
+    /// result = rows[0] & ... & rows[rowsCount - 1], all ones for no rows. Arrays are 64-byte aligned.
+    using AndFunction = void (*)(uint64_t *result, const uint64_t *const *rows, size_t rowsCount,
+                                 size_t wordsCount);
+
+    /// Fused AND and set-bit extraction: fills `ids` with the indexes of the first `maxIds` bits set in
+    /// rows[0] & ... & rows[rowsCount - 1], in increasing order, without materializing the intersection.
+    /// The scan stops as soon as `maxIds` bits were found, and a block is dropped at the first row that
+    /// clears it. Arrays are 64-byte aligned.
+    /// @return number of ids written
+    using MatchFunction = size_t (*)(const uint64_t *const *rows, size_t rowsCount, size_t wordsCount,
+                                     uint32_t *ids, size_t maxIds);
+
+    /// Words ANDed across all the rows before a single store: the result is written once
+    static constexpr size_t BLOCK_WORDS = 8;
+
+    /// Appends the set bits of `words`, the block starting at word `firstWord`, to `ids`
+    inline size_t collectIds(const uint64_t *words, const size_t firstWord, uint32_t *ids, size_t found,
+                             const size_t maxIds) noexcept
+    {
+        for (size_t i = 0; i < BLOCK_WORDS && found < maxIds; ++i)
+        {
+            for (uint64_t word = words[i]; word != 0 && found < maxIds; word &= word - 1)
+                ids[found++] = static_cast<uint32_t>((firstWord + i) * 64 + __builtin_ctzll(word));
+        }
+        return found;
+    }
+
+    inline size_t matchScalarRange(const uint64_t *const *rows, const size_t rowsCount, const size_t begin,
+                                   const size_t end, uint32_t *ids, size_t found, const size_t maxIds) noexcept
+    {
+        for (size_t i = begin; i < end && found < maxIds; ++i)
+        {
+            uint64_t word = ~0ULL;
+            for (size_t row = 0; row < rowsCount && word != 0; ++row)
+                word &= rows[row][i];
+            for (; word != 0 && found < maxIds; word &= word - 1)
+                ids[found++] = static_cast<uint32_t>(i * 64 + __builtin_ctzll(word));
+        }
+        return found;
+    }
+
+    inline size_t matchScalar(const uint64_t *const *rows, const size_t rowsCount, const size_t wordsCount,
+                              uint32_t *ids, const size_t maxIds) noexcept
+    {
+        return matchScalarRange(rows, rowsCount, 0, wordsCount, ids, 0, maxIds);
+    }
+
+    inline void andScalarRange(uint64_t *result, const uint64_t *const *rows, const size_t rowsCount,
+                               const size_t begin, const size_t end) noexcept
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint64_t word = ~0ULL;
+            for (size_t row = 0; row < rowsCount; ++row)
+                word &= rows[row][i];
+            result[i] = word;
+        }
+    }
+
+    inline void andScalar(uint64_t *result, const uint64_t *const *rows, const size_t rowsCount,
+                          const size_t wordsCount) noexcept
+    {
+        andScalarRange(result, rows, rowsCount, 0, wordsCount);
+    }
+
+#if defined(__x86_64__)
+    __attribute__((target("sse2"))) inline void andSse2(uint64_t *result, const uint64_t *const *rows,
+                                                        const size_t rowsCount, const size_t wordsCount) noexcept
+    {
+        const size_t blocksEnd = wordsCount - wordsCount % BLOCK_WORDS;
+        for (size_t i = 0; i < blocksEnd; i += BLOCK_WORDS)
+        {
+            __m128i block[4];
+            for (auto &lane : block)
+                lane = _mm_set1_epi64x(-1);
+            for (size_t row = 0; row < rowsCount; ++row)
+            {
+                const __m128i *words = reinterpret_cast<const __m128i *>(rows[row] + i);
+                for (size_t lane = 0; lane < 4; ++lane)
+                    block[lane] = _mm_and_si128(block[lane], _mm_load_si128(words + lane));
+            }
+            for (size_t lane = 0; lane < 4; ++lane)
+                _mm_store_si128(reinterpret_cast<__m128i *>(result + i) + lane, block[lane]);
+        }
+        andScalarRange(result, rows, rowsCount, blocksEnd, wordsCount);
+    }
+
+    __attribute__((target("sse2"))) inline size_t matchSse2(const uint64_t *const *rows, const size_t rowsCount,
+                                                            const size_t wordsCount, uint32_t *ids,
+                                                            const size_t maxIds) noexcept
+    {
+        const size_t blocksEnd = wordsCount - wordsCount % BLOCK_WORDS;
+        const __m128i zero = _mm_setzero_si128();
+        size_t found = 0;
+
+        for (size_t i = 0; i < blocksEnd && found < maxIds; i += BLOCK_WORDS)
+        {
+            __m128i block[4];
+            for (auto &lane : block)
+                lane = _mm_set1_epi64x(-1);
+
+            bool empty = false;
+            for (size_t row = 0; row < rowsCount && !empty; ++row)
+            {
+                const __m128i *words = reinterpret_cast<const __m128i *>(rows[row] + i);
+                for (size_t lane = 0; lane < 4; ++lane)
+                    block[lane] = _mm_and_si128(block[lane], _mm_load_si128(words + lane));
+                const __m128i any = _mm_or_si128(_mm_or_si128(block[0], block[1]), _mm_or_si128(block[2], block[3]));
+                empty = _mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) == 0xffff;
+            }
+            if (empty)
+                continue;
+
+            alignas(64) uint64_t words[BLOCK_WORDS];
+            for (size_t lane = 0; lane < 4; ++lane)
+                _mm_store_si128(reinterpret_cast<__m128i *>(words) + lane, block[lane]);
+            found = collectIds(words, i, ids, found, maxIds);
+        }
+        return matchScalarRange(rows, rowsCount, blocksEnd, wordsCount, ids, found, maxIds);
+    }
+
+    __attribute__((target("avx2"))) inline void andAvx2(uint64_t *result, const uint64_t *const *rows,
+                                                        const size_t rowsCount, const size_t wordsCount) noexcept
+    {
+        const size_t blocksEnd = wordsCount - wordsCount % BLOCK_WORDS;
+        for (size_t i = 0; i < blocksEnd; i += BLOCK_WORDS)
+        {
+            __m256i low = _mm256_set1_epi64x(-1);
+            __m256i high = low;
+            for (size_t row = 0; row < rowsCount; ++row)
+            {
+                const __m256i *words = reinterpret_cast<const __m256i *>(rows[row] + i);
+                low = _mm256_and_si256(low, _mm256_load_si256(words));
+                high = _mm256_and_si256(high, _mm256_load_si256(words + 1));
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i *>(result + i), low);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(result + i) + 1, high);
+        }
+        andScalarRange(result, rows, rowsCount, blocksEnd, wordsCount);
+    }
+
+    __attribute__((target("avx2"))) inline size_t matchAvx2(const uint64_t *const *rows, const size_t rowsCount,
+                                                            const size_t wordsCount, uint32_t *ids,
+                                                            const size_t maxIds) noexcept
+    {
+        const size_t blocksEnd = wordsCount - wordsCount % BLOCK_WORDS;
+        size_t found = 0;
+
+        for (size_t i = 0; i < blocksEnd && found < maxIds; i += BLOCK_WORDS)
+        {
+            __m256i low = _mm256_set1_epi64x(-1);
+            __m256i high = low;
+            bool empty = false;
+            for (size_t row = 0; row < rowsCount && !empty; ++row)
+            {
+                const __m256i *words = reinterpret_cast<const __m256i *>(rows[row] + i);
+                low = _mm256_and_si256(low, _mm256_load_si256(words));
+                high = _mm256_and_si256(high, _mm256_load_si256(words + 1));
+                const __m256i any = _mm256_or_si256(low, high);
+                empty = _mm256_testz_si256(any, any);
+            }
+            if (empty)
+                continue;
+
+            alignas(64) uint64_t words[BLOCK_WORDS];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(words), low);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(words) + 1, high);
+            found = collectIds(words, i, ids, found, maxIds);
+        }
+        return matchScalarRange(rows, rowsCount, blocksEnd, wordsCount, ids, found, maxIds);
+    }
+
+    __attribute__((target("avx512f"))) inline void andAvx512(uint64_t *result, const uint64_t *const *rows,
+                                                             const size_t rowsCount, const size_t wordsCount) noexcept
+    {
+        const size_t blocksEnd = wordsCount - wordsCount % BLOCK_WORDS;
+        for (size_t i = 0; i < blocksEnd; i += BLOCK_WORDS)
+        {
+            __m512i block = _mm512_set1_epi64(-1);
+            for (size_t row = 0; row < rowsCount; ++row)
+                block = _mm512_and_si512(block, _mm512_load_si512(rows[row] + i));
+            _mm512_store_si512(result + i, block);
+        }
+        andScalarRange(result, rows, rowsCount, blocksEnd, wordsCount);
+    }
+
+    __attribute__((target("avx512f"))) inline size_t matchAvx512(const uint64_t *const *rows, const size_t rowsCount,
+                                                                 const size_t wordsCount, uint32_t *ids,
+                                                                 const size_t maxIds) noexcept
+    {
+        const size_t blocksEnd = wordsCount - wordsCount % BLOCK_WORDS;
+        size_t found = 0;
+
+        for (size_t i = 0; i < blocksEnd && found < maxIds; i += BLOCK_WORDS)
+        {
+            __m512i block = _mm512_set1_epi64(-1);
+            bool empty = false;
+            for (size_t row = 0; row < rowsCount && !empty; ++row)
+            {
+                block = _mm512_and_si512(block, _mm512_load_si512(rows[row] + i));
+                empty = _mm512_test_epi64_mask(block, block) == 0;
+            }
+            if (empty)
+                continue;
+
+            alignas(64) uint64_t words[BLOCK_WORDS];
+            _mm512_store_si512(words, block);
+            found = collectIds(words, i, ids, found, maxIds);
+        }
+        return matchScalarRange(rows, rowsCount, blocksEnd, wordsCount, ids, found, maxIds);
+    }
+#endif
+
+    inline bool supported(const Kernel kernel) noexcept
+    {
+#if defined(__x86_64__)
+        switch (kernel)
+        {
+        case Kernel::Scalar:
+            return true;
+        case Kernel::Sse2:
+            return __builtin_cpu_supports("sse2");
+        case Kernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::Avx512:
+            return __builtin_cpu_supports("avx512f");
+        }
+        return false;
+#else
+        return kernel == Kernel::Scalar;
+#endif
+    }
+
+    /// Widest kernel the CPU supports
+    inline Kernel best() noexcept
+    {
+        for (const Kernel kernel : {Kernel::Avx512, Kernel::Avx2, Kernel::Sse2})
+        {
+            if (supported(kernel))
+                return kernel;
+        }
+        return Kernel::Scalar;
+    }
+
+    /// @param kernel must be supported(), unsupported variants fall back to the scalar one
+    inline AndFunction andFunction(const Kernel kernel) noexcept
+    {
+        if (!supported(kernel))
+            return &andScalar;
+
+        switch (kernel)
+        {
+#if defined(__x86_64__)
+        case Kernel::Sse2:
+            return &andSse2;
+        case Kernel::Avx2:
+            return &andAvx2;
+        case Kernel::Avx512:
+            return &andAvx512;
+#endif
+        default:
+            return &andScalar;
+        }
+    }
+
+    /// Kernel of the widest supported variant, resolved once from CPUID on first use
+    inline AndFunction andFunction() noexcept
+    {
+        static const AndFunction function = andFunction(best());
+        return function;
+    }
+
+    /// @param kernel must be supported(), unsupported variants fall back to the scalar one
+    inline MatchFunction matchFunction(const Kernel kernel) noexcept
+    {
+        if (!supported(kernel))
+            return &matchScalar;
+
+        switch (kernel)
+        {
+#if defined(__x86_64__)
+        case Kernel::Sse2:
+            return &matchSse2;
+        case Kernel::Avx2:
+            return &matchAvx2;
+        case Kernel::Avx512:
+            return &matchAvx512;
+#endif
+        default:
+            return &matchScalar;
+        }
+    }
+
+    /// Match kernel of the widest supported variant, resolved once from CPUID on first use
+    inline MatchFunction matchFunction() noexcept
+    {
+        static const MatchFunction function = matchFunction(best());
+        return function;
+    }
+
+    inline const char *name(const Kernel kernel) noexcept
+    {
+        switch (kernel)
+        {
+        case Kernel::Sse2:
+            return "sse2";
+        case Kernel::Avx2:
+            return "avx2";
+        case Kernel::Avx512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+} // namespace BitsetKernels
@@ -0,0 +1,121 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// Footprint of a BitsetPool: what its references would take with a private copy each, against what the
+/// distinct copies take
+class BitsetPoolReport
+{
+  public:
+    size_t mDistinctCount;
+    size_t mReferencesCount;
+    size_t mDistinctBytes;
+    size_t mReferencedBytes;
+};
+
+/// Hash-consing pool of immutable bitsets: acquiring a bitset equal to one already in the pool returns the
+/// canonical copy and bumps its reference count, and the copy is freed with its last reference. Rule
+/// compilers build the leaves of their lookup structures through it, so the many leaves matching the same
+/// rule subset share one copy. Build-time only, not thread-safe; the returned copies are safe to read from
+/// any thread while referenced. TBitset needs data(), size() and operator==.
+template <typename TBitset>
+class BitsetPool
+{
+  private:
+    class Entry
+    {
+      public:
+        std::unique_ptr<TBitset> mBits;
+        size_t mReferences;
+    };
+
+    std::unordered_map<uint64_t, std::vector<Entry>> m_Entries; // by content hash
+    size_t m_DistinctCount{0};
+    size_t m_ReferencesCount{0};
+
+  public:
+    BitsetPool() = default;
+    ~BitsetPool()
+    {
+        assert(m_ReferencesCount == 0);
+    }
+
+    // Deleted copy constructor and assignment operator
+    BitsetPool(const BitsetPool &) = delete;
+    BitsetPool &operator=(const BitsetPool &) = delete;
+
+    /// @return canonical copy of `bits`, to give back with release()
+    const TBitset *acquire(const TBitset &bits)
+    {
+        std::vector<Entry> &candidates = m_Entries[hash(bits)];
+        ++m_ReferencesCount;
+        for (Entry &entry : candidates)
+        {
+            if (*entry.mBits == bits)
+            {
+                ++entry.mReferences;
+                return entry.mBits.get();
+            }
+        }
+
+        candidates.push_back(Entry{std::make_unique<TBitset>(bits), 1});
+        ++m_DistinctCount;
+        return candidates.back().mBits.get();
+    }
+
+    void release(const TBitset *bits)
+    {
+        const auto found = m_Entries.find(hash(*bits));
+        assert(found != m_Entries.end());
+
+        std::vector<Entry> &candidates = found->second;
+        for (auto entry = candidates.begin(); entry != candidates.end(); ++entry)
+        {
+            if (entry->mBits.get() != bits)
+                continue;
+
+            --m_ReferencesCount;
+            if (--entry->mReferences == 0)
+            {
+                candidates.erase(entry);
+                --m_DistinctCount;
+                if (candidates.empty())
+                    m_Entries.erase(found);
+            }
+            return;
+        }
+        assert(false && "bitset not acquired from this pool");
+    }
+
+    size_t distinctCount() const noexcept
+    {
+        return m_DistinctCount;
+    }
+
+    size_t referencesCount() const noexcept
+    {
+        return m_ReferencesCount;
+    }
+
+    BitsetPoolReport report() const noexcept
+    {
+        return BitsetPoolReport{m_DistinctCount, m_ReferencesCount, m_DistinctCount * sizeof(TBitset),
+                                m_ReferencesCount * sizeof(TBitset)};
+    }
+
+    static uint64_t hash(const TBitset &bits) noexcept
+    {
+        uint64_t hash = 0;
+        const uint64_t *words = bits.data();
+        for (size_t i = 0; i < TBitset::size() / 64; ++i)
+        {
+            hash = (hash ^ words[i]) * 0x9e3779b97f4a7c15ULL;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+/// How a table reclaims an entry inline on insert once its occupancy passes the high watermark,
+/// instead of failing the insert when its pools run dry
+enum class EvictionPolicy : uint8_t
+{
+    None,           // inserts fail once the table is full
+    Clock,          // CLOCK second chance: a hand sweeps the table, skipping once every entry hit since its last pass
+    OldestInBucket, // least recently seen entry of the bucket being inserted into, or of the next non-empty one
+    SampledLru,     // least recently seen entry among a random sample of K
+};
+
+class EvictionStats
+{
+  public:
+    uint64_t mEvictions{0};      // entries reclaimed to make room for an insert
+    uint64_t mEvictionMisses{0}; // eviction attempts that found no victim within their scan budget
+    uint64_t mInsertFailures{0}; // inserts that failed even after trying to evict
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+
+#include <rte_hash_crc.h>
+#include <rte_jhash.h>
+#include <rte_thash.h>
+
+/// Hash policies for rte_hash based containers. Each one exposes `hash` with the rte_hash_function
+/// signature, so it can be plugged in as `rte_hash_parameters::hash_func`.
+
+/// Bob Jenkins' hash, works for any key length
+struct JHashPolicy
+{
+    static uint32_t hash(const void *key, uint32_t keyLength, uint32_t initValue)
+    {
+        return rte_jhash(key, keyLength, initValue);
+    }
+};
+
+/// CRC32C, computed with the SSE4.2 / ARMv8 crc32 instructions when the CPU has them
+struct Crc32cHashPolicy
+{
+    static uint32_t hash(const void *key, uint32_t keyLength, uint32_t initValue)
+    {
+        return rte_hash_crc(key, keyLength, initValue);
+    }
+};
+
+/// Software Toeplitz hash with the symmetric 0x6d5a RSS key: swapping 16-bit aligned fields, such as
+/// source and destination addresses or ports, yields the same hash. The key is hashed as host order
+/// 32-bit words, so keyLength must be a multiple of 4; the value matches the NIC RSS hash when the key
+/// holds exactly the NIC's hash input and the NIC uses the same RSS key.
+struct SymmetricToeplitzHashPolicy
+{
+    static constexpr uint8_t RSS_KEY[40] = {
+        0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+        0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+        0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    };
+
+    static uint32_t hash(const void *key, uint32_t keyLength, uint32_t initValue)
+    {
+        // rte_softrss only reads the tuple
+        return rte_softrss(static_cast<uint32_t *>(const_cast<void *>(key)), keyLength / 4, RSS_KEY) ^ initValue;
+    }
+};
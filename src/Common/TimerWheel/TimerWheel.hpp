@@ -0,0 +1,160 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// Hashed timing wheel with coarse ticks and lazy rescheduling.
+/// Timers are intrusive nodes linked into the slot of their deadline tick. Extending a deadline with
+/// touch() only writes the node: the node is moved to its new slot the next time the wheel reaches its
+/// old one. Deadlines beyond one revolution simply stay in their slot for another round, so any TTL
+/// works with any wheel size.
+/// Single writer: one lcore calls init(), schedule(), cancel() and advance(). Reader lcores may call
+/// touch() and now() concurrently, the deadline and the coarse time are accessed atomically. A touch racing
+/// with the expiry of its node is lost, the node expires.
+class TimerWheel
+{
+  public:
+    class Node
+    {
+      public:
+        Node *mPrev{nullptr};
+        Node *mNext{nullptr};
+        uint64_t mDeadline{0};
+
+        bool linked() const noexcept
+        {
+            return mPrev != nullptr;
+        }
+    };
+
+    TimerWheel() = default;
+    ~TimerWheel() = default;
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    // Slots live on the heap, so moving keeps the linked nodes valid
+    TimerWheel(TimerWheel &&) noexcept = default;
+    TimerWheel &operator=(TimerWheel &&) noexcept = default;
+
+    /// @param tickCycles duration of a slot, in the same unit as the timestamps
+    /// @param slotsCount number of slots, rounded up to a power of two
+    /// @param now        current time
+    void init(const uint64_t tickCycles, uint32_t slotsCount, const uint64_t now)
+    {
+        uint32_t roundedSlotsCount = 1;
+        while (roundedSlotsCount < slotsCount)
+            roundedSlotsCount <<= 1;
+
+        m_TickCycles = tickCycles ? tickCycles : 1;
+        m_SlotsMask = roundedSlotsCount - 1;
+        m_CurrentTick = now / m_TickCycles;
+        m_Now = now;
+        m_Slots = std::vector<Node>(roundedSlotsCount);
+        for (auto &slot : m_Slots)
+            slot.mPrev = slot.mNext = &slot;
+    }
+
+    /// Coarse current time: the timestamp of the last advance()
+    uint64_t now() const noexcept
+    {
+        return __atomic_load_n(&m_Now, __ATOMIC_RELAXED);
+    }
+
+    /// Links `node` so it expires at `deadline`, unlinking it first if needed
+    void schedule(Node *node, const uint64_t deadline) noexcept
+    {
+        cancel(node);
+        __atomic_store_n(&node->mDeadline, deadline, __ATOMIC_RELAXED);
+        link(node);
+    }
+
+    /// O(1) deadline extension of a linked node: a single store, the slot move is deferred. Safe from
+    /// reader lcores.
+    static void touch(Node *node, const uint64_t deadline) noexcept
+    {
+        __atomic_store_n(&node->mDeadline, deadline, __ATOMIC_RELAXED);
+    }
+
+    static uint64_t deadline(const Node *node) noexcept
+    {
+        return __atomic_load_n(&node->mDeadline, __ATOMIC_RELAXED);
+    }
+
+    static void cancel(Node *node) noexcept
+    {
+        if (!node->linked())
+            return;
+        node->mPrev->mNext = node->mNext;
+        node->mNext->mPrev = node->mPrev;
+        node->mPrev = node->mNext = nullptr;
+    }
+
+    /// Processes every tick that fully elapsed up to `now`, expiring due nodes in one batch per slot and
+    /// moving touched nodes to the slot of their new deadline. Expired nodes are unlinked before
+    /// `onExpire(Node *)` runs, which may schedule them again.
+    /// @return number of expired nodes
+    template <typename F>
+    uint32_t advance(const uint64_t now, F &&onExpire)
+    {
+        const uint64_t targetTick = now / m_TickCycles;
+        uint32_t expired = 0;
+        uint64_t slotsVisited = 0;
+
+        __atomic_store_n(&m_Now, now, __ATOMIC_RELAXED);
+
+        // After a long stall one visit of every slot catches up
+        for (; m_CurrentTick < targetTick && slotsVisited <= m_SlotsMask; ++m_CurrentTick, ++slotsVisited)
+        {
+            // Move the slot to a local list, so callbacks can cancel any node safely
+            Node &slot = m_Slots[m_CurrentTick & m_SlotsMask];
+            if (slot.mNext == &slot)
+                continue;
+
+            Node pending;
+            pending.mNext = slot.mNext;
+            pending.mPrev = slot.mPrev;
+            pending.mNext->mPrev = &pending;
+            pending.mPrev->mNext = &pending;
+            slot.mPrev = slot.mNext = &slot;
+
+            while (pending.mNext != &pending)
+            {
+                Node *node = pending.mNext;
+                cancel(node);
+
+                if (deadline(node) <= now)
+                {
+                    ++expired;
+                    onExpire(node);
+                }
+                else
+                {
+                    link(node);
+                }
+            }
+        }
+        m_CurrentTick = targetTick;
+
+        return expired;
+    }
+
+  private:
+    void link(Node *node) noexcept
+    {
+        uint64_t tick = deadline(node) / m_TickCycles;
+        if (tick < m_CurrentTick)
+            tick = m_CurrentTick;
+
+        Node &slot = m_Slots[tick & m_SlotsMask];
+        node->mPrev = slot.mPrev;
+        node->mNext = &slot;
+        slot.mPrev->mNext = node;
+        slot.mPrev = node;
+    }
+
+    std::vector<Node> m_Slots;
+    uint64_t m_TickCycles{1};
+    uint64_t m_SlotsMask{0};
+    uint64_t m_CurrentTick{0};
+    uint64_t m_Now{0};
+};
@@ -0,0 +1,293 @@
+#pragma once
+#include "FiveTuple.hpp"
+#include "FlowBucket.hpp"
+#include "TrackDescriptor.hpp"
+#include <cstdint>
+#include <new>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+
+/// Open-addressing variant of FlowTable. Every hash slot is a single FlowBucket cache line holding
+/// the 8-bit RSS tags and 32-bit entry indices of up to FlowBucket::SLOTS_COUNT flows, so a lookup
+/// touches the bucket line and the matching entry instead of chasing TrackBucket pointers.
+/// Full buckets overflow into extension buckets linked by index. Flows only hold their inline matched
+/// rules, there is no overflow pool.
+class BucketFlowTable
+{
+  private:
+    static constexpr uint32_t BUCKETS_COUNT = 1 << 20;
+    static constexpr uint32_t EXTENSION_BUCKETS_COUNT = 1 << 18;
+    static constexpr uint32_t ENTRIES_COUNT = (1 << 22) - 1;
+    static constexpr uint32_t BULK_GROUP_SIZE = 32;
+
+    class FlowEntry
+    {
+      public:
+        FiveTuple mFiveTuple;
+        TrackDescriptor mTrackDescriptor;
+    };
+
+    FlowBucket *m_Buckets;
+    FlowBucket *m_ExtensionBuckets; // index 0 is never used
+    FlowEntry *m_Entries;           // index 0 is never used
+    uint32_t *m_FreeExtensionBuckets;
+    uint32_t *m_FreeEntries;
+    uint32_t m_FreeExtensionBucketsCount;
+    uint32_t m_FreeEntriesCount;
+
+  public:
+    explicit BucketFlowTable()
+        : m_Buckets(nullptr)
+        , m_ExtensionBuckets(nullptr)
+        , m_Entries(nullptr)
+        , m_FreeExtensionBuckets(nullptr)
+        , m_FreeEntries(nullptr)
+        , m_FreeExtensionBucketsCount(0)
+        , m_FreeEntriesCount(0)
+    {
+        m_Buckets = reinterpret_cast<FlowBucket *>(rte_zmalloc(NULL, sizeof(FlowBucket) * BUCKETS_COUNT, 64));
+        m_ExtensionBuckets = reinterpret_cast<FlowBucket *>(
+            rte_zmalloc(NULL, sizeof(FlowBucket) * (EXTENSION_BUCKETS_COUNT + 1), 64));
+        m_Entries = reinterpret_cast<FlowEntry *>(rte_zmalloc(NULL, sizeof(FlowEntry) * (ENTRIES_COUNT + 1), 64));
+        m_FreeExtensionBuckets =
+            reinterpret_cast<uint32_t *>(rte_zmalloc(NULL, sizeof(uint32_t) * EXTENSION_BUCKETS_COUNT, 64));
+        m_FreeEntries = reinterpret_cast<uint32_t *>(rte_zmalloc(NULL, sizeof(uint32_t) * ENTRIES_COUNT, 64));
+        if (!m_Buckets || !m_ExtensionBuckets || !m_Entries || !m_FreeExtensionBuckets || !m_FreeEntries)
+        {
+            release();
+            throw std::bad_alloc();
+        }
+
+        // Free lists are stacks, lower indices are handed out first
+        for (uint32_t index = EXTENSION_BUCKETS_COUNT; index > 0; --index)
+            m_FreeExtensionBuckets[m_FreeExtensionBucketsCount++] = index;
+        for (uint32_t index = ENTRIES_COUNT; index > 0; --index)
+            m_FreeEntries[m_FreeEntriesCount++] = index;
+    }
+
+    ~BucketFlowTable() noexcept
+    {
+        release();
+    }
+
+    BucketFlowTable(const BucketFlowTable &) = delete;
+    BucketFlowTable &operator=(const BucketFlowTable &) = delete;
+
+    /// @param direction optional, set to the direction of the packet relative to the first packet of the
+    ///                  flow, Forward on a miss
+    TrackDescriptor *lookup(const uint32_t hash, const FiveTuple &fiveTuple,
+                            FlowDirection *direction = nullptr) noexcept
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = fiveTuple.canonical(packetDirection);
+
+        const uint32_t entryIndex = find(&m_Buckets[bucketIndex(hash)], hash, canonicalFiveTuple);
+        TrackDescriptor *trackDescriptor = entryIndex ? &m_Entries[entryIndex].mTrackDescriptor : nullptr;
+        if (direction)
+            *direction = trackDescriptor ? trackDescriptor->direction(packetDirection) : FlowDirection::Forward;
+        return trackDescriptor;
+    }
+
+    /// Burst variant of lookup(), see FlowTable::lookup_bulk(). The bucket lines of the group are
+    /// prefetched first, then the entries whose tag matches, then the keys are compared.
+    uint32_t lookup_bulk(const uint32_t *hashes, const FiveTuple *keys, TrackDescriptor **out, const uint32_t n,
+                         FlowDirection *directions = nullptr) noexcept
+    {
+        FiveTuple canonicalKeys[BULK_GROUP_SIZE];
+        FlowDirection packetDirections[BULK_GROUP_SIZE];
+        uint32_t hits = 0;
+
+        for (uint32_t base = 0; base < n; base += BULK_GROUP_SIZE)
+        {
+            const uint32_t count = (n - base < BULK_GROUP_SIZE) ? (n - base) : BULK_GROUP_SIZE;
+
+            // Stage 1: prefetch the bucket lines
+            for (uint32_t i = 0; i < count; ++i)
+                rte_prefetch0(&m_Buckets[bucketIndex(hashes[base + i])]);
+
+            // Stage 2: prefetch the entries whose tag matches
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                canonicalKeys[i] = keys[base + i].canonical(packetDirections[i]);
+
+                const FlowBucket &bucket = m_Buckets[bucketIndex(hashes[base + i])];
+                for (uint32_t mask = bucket.match(hashes[base + i] & 0xff); mask; mask &= mask - 1)
+                {
+                    const uint32_t entryIndex = bucket.mEntries[__builtin_ctz(mask)];
+                    if (entryIndex)
+                        rte_prefetch0(&m_Entries[entryIndex]);
+                }
+            }
+
+            // Stage 3: compare the keys
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t entryIndex =
+                    find(&m_Buckets[bucketIndex(hashes[base + i])], hashes[base + i], canonicalKeys[i]);
+                TrackDescriptor *trackDescriptor = entryIndex ? &m_Entries[entryIndex].mTrackDescriptor : nullptr;
+                if (directions)
+                    directions[base + i] = trackDescriptor ? trackDescriptor->direction(packetDirections[i])
+                                                           : FlowDirection::Forward;
+                out[base + i] = trackDescriptor;
+                hits += (entryIndex != 0);
+            }
+        }
+
+        return hits;
+    }
+
+    bool delete_entry(const uint32_t hash, TrackDescriptor *trackDescriptor)
+    {
+        if (trackDescriptor == nullptr)
+            return false;
+
+        const uint32_t entryIndex = static_cast<uint32_t>(
+            (reinterpret_cast<char *>(trackDescriptor) - reinterpret_cast<char *>(&m_Entries[0].mTrackDescriptor)) /
+            sizeof(FlowEntry));
+
+        FlowBucket *previous_bucket = nullptr;
+        FlowBucket *current_bucket = &m_Buckets[bucketIndex(hash)];
+
+        for (; current_bucket; previous_bucket = current_bucket, current_bucket = nextBucket(current_bucket))
+        {
+            for (uint32_t slot = 0; slot < FlowBucket::SLOTS_COUNT; ++slot)
+            {
+                if (current_bucket->mEntries[slot] != entryIndex)
+                    continue;
+
+                current_bucket->mEntries[slot] = 0;
+                m_FreeEntries[m_FreeEntriesCount++] = entryIndex;
+
+                // Give an emptied extension bucket back
+                if (previous_bucket != nullptr && isEmpty(*current_bucket))
+                {
+                    const uint32_t extensionIndex = previous_bucket->mNextExtension;
+                    previous_bucket->mNextExtension = current_bucket->mNextExtension;
+                    current_bucket->mNextExtension = 0;
+                    m_FreeExtensionBuckets[m_FreeExtensionBucketsCount++] = extensionIndex;
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool insert(const uint32_t hash, const FiveTuple &packetFiveTuple, const uint16_t matchedRuleId)
+    {
+        const uint8_t RSS8LSBs = hash & 0xff;
+        FlowDirection packetDirection;
+        const FiveTuple fiveTuple = packetFiveTuple.canonical(packetDirection);
+
+        FlowBucket *current_bucket = &m_Buckets[bucketIndex(hash)];
+
+        if (find(current_bucket, hash, fiveTuple))
+            return true;
+
+        // Look for a free slot along the chain, remembering the last bucket
+        FlowBucket *target_bucket = nullptr;
+        uint32_t target_slot = 0;
+        FlowBucket *last_bucket = current_bucket;
+        for (; current_bucket && !target_bucket; current_bucket = nextBucket(current_bucket))
+        {
+            last_bucket = current_bucket;
+            for (uint32_t slot = 0; slot < FlowBucket::SLOTS_COUNT; ++slot)
+            {
+                if (current_bucket->mEntries[slot] == 0)
+                {
+                    target_bucket = current_bucket;
+                    target_slot = slot;
+                    break;
+                }
+            }
+        }
+
+        if (m_FreeEntriesCount == 0)
+            return false;
+
+        if (target_bucket == nullptr) // chain is full, link a new extension bucket
+        {
+            if (m_FreeExtensionBucketsCount == 0)
+                return false;
+
+            const uint32_t extensionIndex = m_FreeExtensionBuckets[--m_FreeExtensionBucketsCount];
+            target_bucket = &m_ExtensionBuckets[extensionIndex];
+            target_slot = 0;
+            last_bucket->mNextExtension = extensionIndex;
+        }
+
+        const uint32_t entryIndex = m_FreeEntries[--m_FreeEntriesCount];
+        FlowEntry &entry = m_Entries[entryIndex];
+        entry.mFiveTuple = fiveTuple;
+        new (&entry.mTrackDescriptor) TrackDescriptor{.mLastSeen = rte_rdtsc(),
+                                                      .mPackets = 0,
+                                                      .mFlags = TrackDescriptor::origin_flags(packetDirection),
+                                                      .mRulesCount = 0,
+                                                      .mInlineRules = {},
+                                                      .mRules = nullptr};
+        entry.mTrackDescriptor.add_rule(std::make_tuple(matchedRuleId, static_cast<uint16_t>(100)), nullptr);
+
+        target_bucket->mTags[target_slot] = RSS8LSBs;
+        target_bucket->mEntries[target_slot] = entryIndex;
+
+        return true;
+    }
+
+  private:
+    static uint32_t bucketIndex(const uint32_t hash) noexcept
+    {
+        return (hash >> 8) & (BUCKETS_COUNT - 1);
+    }
+
+    static bool isEmpty(const FlowBucket &bucket) noexcept
+    {
+        for (uint32_t slot = 0; slot < FlowBucket::SLOTS_COUNT; ++slot)
+        {
+            if (bucket.mEntries[slot] != 0)
+                return false;
+        }
+        return true;
+    }
+
+    FlowBucket *nextBucket(const FlowBucket *bucket) const noexcept
+    {
+        return bucket->mNextExtension ? &m_ExtensionBuckets[bucket->mNextExtension] : nullptr;
+    }
+
+    /// Returns the entry index of the flow, 0 if it is not tracked. Entries store the canonical five tuple.
+    uint32_t find(const FlowBucket *current_bucket, const uint32_t hash,
+                  const FiveTuple &canonicalFiveTuple) const noexcept
+    {
+        const uint8_t RSS8LSBs = hash & 0xff;
+
+        for (; current_bucket; current_bucket = nextBucket(current_bucket))
+        {
+            for (uint32_t mask = current_bucket->match(RSS8LSBs); mask; mask &= mask - 1)
+            {
+                const uint32_t entryIndex = current_bucket->mEntries[__builtin_ctz(mask)];
+                if (entryIndex == 0)
+                    continue;
+
+                if (m_Entries[entryIndex].mFiveTuple == canonicalFiveTuple)
+                    return entryIndex;
+            }
+        }
+
+        return 0;
+    }
+
+    void release() noexcept
+    {
+        if (m_Buckets)
+            rte_free(m_Buckets);
+        if (m_ExtensionBuckets)
+            rte_free(m_ExtensionBuckets);
+        if (m_Entries)
+            rte_free(m_Entries);
+        if (m_FreeExtensionBuckets)
+            rte_free(m_FreeExtensionBuckets);
+        if (m_FreeEntries)
+            rte_free(m_FreeEntries);
+    }
+};
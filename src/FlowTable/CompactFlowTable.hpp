@@ -0,0 +1,228 @@
+#pragma once
+#include "CompactTrackBucket.hpp"
+#include "FiveTuple.hpp"
+#include "TrackDescriptor.hpp"
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <utility>
+
+/// Index-linked variant of FlowTable. Track buckets and descriptors live in two parallel arrays sized
+/// for the 2^22 flows the mempools were capped at, so 32-bit indices replace every pointer: the head
+/// array takes 64 MB instead of 128 MB and a chain node takes 20 bytes. Chains are singly linked,
+/// delete_entry() walks the chain from its head slot. Flows only hold their inline matched rules, there
+/// is no overflow pool. Owned by a single lcore.
+class CompactFlowTable
+{
+  public:
+    static constexpr uint32_t HEAD_SLOTS_COUNT = 1 << 24;
+
+  private:
+    static constexpr uint32_t ENTRIES_COUNT = (1 << 22) - 1;
+    static constexpr uint32_t BULK_GROUP_SIZE = 32;
+
+    uint32_t *m_HashBuckets;             // head slot -> track bucket index, 0 is an empty slot
+    CompactTrackBucket *m_TrackBuckets;  // index 0 is never used
+    TrackDescriptor *m_TrackDescriptors; // parallel to m_TrackBuckets
+    uint32_t *m_FreeEntries;
+    uint32_t m_FreeEntriesCount;
+
+  public:
+    explicit CompactFlowTable()
+        : m_HashBuckets(nullptr)
+        , m_TrackBuckets(nullptr)
+        , m_TrackDescriptors(nullptr)
+        , m_FreeEntries(nullptr)
+        , m_FreeEntriesCount(0)
+    {
+        m_HashBuckets = reinterpret_cast<uint32_t *>(rte_zmalloc(NULL, sizeof(uint32_t) * HEAD_SLOTS_COUNT, 64));
+        m_TrackBuckets = reinterpret_cast<CompactTrackBucket *>(
+            rte_zmalloc(NULL, sizeof(CompactTrackBucket) * (ENTRIES_COUNT + 1), 64));
+        m_TrackDescriptors =
+            reinterpret_cast<TrackDescriptor *>(rte_zmalloc(NULL, sizeof(TrackDescriptor) * (ENTRIES_COUNT + 1), 64));
+        m_FreeEntries = reinterpret_cast<uint32_t *>(rte_zmalloc(NULL, sizeof(uint32_t) * ENTRIES_COUNT, 64));
+        if (!m_HashBuckets || !m_TrackBuckets || !m_TrackDescriptors || !m_FreeEntries)
+        {
+            release();
+            throw std::bad_alloc();
+        }
+
+        // Free list is a stack, lower indices are handed out first
+        for (uint32_t index = ENTRIES_COUNT; index > 0; --index)
+            m_FreeEntries[m_FreeEntriesCount++] = index;
+    }
+
+    ~CompactFlowTable() noexcept
+    {
+        release();
+    }
+
+    CompactFlowTable(const CompactFlowTable &) = delete;
+    CompactFlowTable &operator=(const CompactFlowTable &) = delete;
+
+    /// Number of tracked flows
+    uint32_t size() const noexcept
+    {
+        return ENTRIES_COUNT - m_FreeEntriesCount;
+    }
+
+    /// @param direction optional, set to the direction of the packet relative to the first packet of the
+    ///                  flow, Forward on a miss
+    TrackDescriptor *lookup(const uint32_t hash, const FiveTuple &fiveTuple,
+                            FlowDirection *direction = nullptr) noexcept
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = fiveTuple.canonical(packetDirection);
+
+        const uint32_t index = find(m_HashBuckets[hash >> 8], canonicalFiveTuple);
+        TrackDescriptor *trackDescriptor = index ? &m_TrackDescriptors[index] : nullptr;
+        if (direction)
+            *direction = trackDescriptor ? trackDescriptor->direction(packetDirection) : FlowDirection::Forward;
+        return trackDescriptor;
+    }
+
+    /// Burst variant of lookup(), see FlowTable::lookup_bulk()
+    uint32_t lookup_bulk(const uint32_t *hashes, const FiveTuple *keys, TrackDescriptor **out, const uint32_t n,
+                         FlowDirection *directions = nullptr) noexcept
+    {
+        uint32_t heads[BULK_GROUP_SIZE];
+        FiveTuple canonicalKeys[BULK_GROUP_SIZE];
+        FlowDirection packetDirections[BULK_GROUP_SIZE];
+        uint32_t hits = 0;
+
+        for (uint32_t base = 0; base < n; base += BULK_GROUP_SIZE)
+        {
+            const uint32_t count = (n - base < BULK_GROUP_SIZE) ? (n - base) : BULK_GROUP_SIZE;
+
+            // Stage 1: prefetch the head slots
+            for (uint32_t i = 0; i < count; ++i)
+                rte_prefetch0(&m_HashBuckets[hashes[base + i] >> 8]);
+
+            // Stage 2: load the heads and prefetch the first track bucket of each chain
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                canonicalKeys[i] = keys[base + i].canonical(packetDirections[i]);
+
+                heads[i] = m_HashBuckets[hashes[base + i] >> 8];
+                if (heads[i] != 0)
+                    rte_prefetch0(&m_TrackBuckets[heads[i]]);
+            }
+
+            // Stage 3: walk the chains, prefetching the descriptor the caller is about to touch
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t index = find(heads[i], canonicalKeys[i]);
+                TrackDescriptor *trackDescriptor = nullptr;
+                if (index != 0)
+                {
+                    trackDescriptor = &m_TrackDescriptors[index];
+                    rte_prefetch0(trackDescriptor);
+                    ++hits;
+                }
+                if (directions)
+                    directions[base + i] = trackDescriptor ? trackDescriptor->direction(packetDirections[i])
+                                                           : FlowDirection::Forward;
+                out[base + i] = trackDescriptor;
+            }
+        }
+
+        return hits;
+    }
+
+    bool delete_entry(const uint32_t hash, TrackDescriptor *trackDescriptor)
+    {
+        if (trackDescriptor == nullptr)
+            return false;
+
+        const uint32_t index = static_cast<uint32_t>(trackDescriptor - m_TrackDescriptors);
+
+        for (uint32_t *link = &m_HashBuckets[hash >> 8]; *link != 0; link = &m_TrackBuckets[*link].mNext)
+        {
+            if (*link != index)
+                continue;
+
+            *link = m_TrackBuckets[index].mNext;
+            m_FreeEntries[m_FreeEntriesCount++] = index;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool insert(const uint32_t hash, const FiveTuple &packetFiveTuple, const uint16_t matchedRuleId)
+    {
+        return find_or_insert(hash, packetFiveTuple, [matchedRuleId](TrackDescriptor &trackDescriptor) {
+                   trackDescriptor.add_rule(std::make_tuple(matchedRuleId, static_cast<uint16_t>(100)), nullptr);
+               }).first != nullptr;
+    }
+
+    /// See FlowTable::find_or_insert(). The node is implied by the index of the descriptor.
+    template <typename Init>
+    std::pair<TrackDescriptor *, bool> find_or_insert(const uint32_t hash, const FiveTuple &packetFiveTuple,
+                                                      Init &&init, FlowDirection *direction = nullptr)
+    {
+        const uint32_t RSS24MSBs = hash >> 8;
+
+        FlowDirection packetDirection;
+        const FiveTuple fiveTuple = packetFiveTuple.canonical(packetDirection);
+
+        const uint32_t existingIndex = find(m_HashBuckets[RSS24MSBs], fiveTuple);
+        if (existingIndex != 0)
+        {
+            if (direction)
+                *direction = m_TrackDescriptors[existingIndex].direction(packetDirection);
+            return {&m_TrackDescriptors[existingIndex], false};
+        }
+
+        if (direction)
+            *direction = FlowDirection::Forward;
+
+        if (m_FreeEntriesCount == 0)
+            return {nullptr, false};
+
+        const uint32_t index = m_FreeEntries[--m_FreeEntriesCount];
+        TrackDescriptor *trackDescriptor = &m_TrackDescriptors[index];
+        new (trackDescriptor) TrackDescriptor{.mLastSeen = rte_rdtsc(),
+                                              .mPackets = 0,
+                                              .mFlags = TrackDescriptor::origin_flags(packetDirection),
+                                              .mRulesCount = 0,
+                                              .mInlineRules = {},
+                                              .mRules = nullptr};
+        init(*trackDescriptor);
+
+        CompactTrackBucket &trackBucket = m_TrackBuckets[index];
+        memcpy(trackBucket.mFiveTuple, &fiveTuple, sizeof(trackBucket.mFiveTuple));
+        trackBucket.mNext = m_HashBuckets[RSS24MSBs];
+        m_HashBuckets[RSS24MSBs] = index;
+
+        return {trackDescriptor, true};
+    }
+
+  private:
+    /// Returns the index of the flow, 0 if it is not tracked. Nodes store the canonical five tuple.
+    uint32_t find(uint32_t index, const FiveTuple &canonicalFiveTuple) const noexcept
+    {
+        for (; index != 0; index = m_TrackBuckets[index].mNext)
+        {
+            if (FiveTuple::equal(m_TrackBuckets[index].mFiveTuple, &canonicalFiveTuple))
+                return index;
+        }
+
+        return 0;
+    }
+
+    void release() noexcept
+    {
+        if (m_HashBuckets)
+            rte_free(m_HashBuckets);
+        if (m_TrackBuckets)
+            rte_free(m_TrackBuckets);
+        if (m_TrackDescriptors)
+            rte_free(m_TrackDescriptors);
+        if (m_FreeEntries)
+            rte_free(m_FreeEntries);
+    }
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+/// Chain node of CompactFlowTable: the canonical five tuple as raw bytes, so the node only needs 4-byte
+/// alignment, and the pool index of the next node. A node and its track descriptor share the same index.
+class CompactTrackBucket
+{
+  public:
+    uint8_t mFiveTuple[16];
+    uint32_t mNext; // 0 ends the chain
+};
+
+static_assert(sizeof(CompactTrackBucket) == 20, "CompactTrackBucket must stay 20 bytes");
@@ -1,20 +1,53 @@
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-class FiveTuple
+/// Direction of a packet: FiveTuple::canonical() reports it relative to the canonical form of the flow
+/// key, the flow tables relative to the first packet of the flow
+enum class FlowDirection : uint8_t
+{
+    Forward = 0, // the packet source is the canonical source endpoint, or the flow initiator
+    Reverse = 1,
+};
+
+/// Flow key with a fixed, packed 16-byte layout:
+///   [0..3] source address, [4..7] destination address, [8..9] source port,
+///   [10..11] destination port, [12] protocol, [13..15] padding.
+/// Every member, padding included, is zero-initialized, so keys compare and hash as 16 raw bytes.
+class alignas(16) FiveTuple
 {
   public:
-    uint32_t mSourceAddress;
-    uint32_t mDestinationAddress;
-    uint16_t mSourcePort;
-    uint16_t mDestinationPort;
-    uint8_t mProtocol;
+    uint32_t mSourceAddress{0};
+    uint32_t mDestinationAddress{0};
+    uint16_t mSourcePort{0};
+    uint16_t mDestinationPort{0};
+    uint8_t mProtocol{0};
+    uint8_t mPadding[3]{0, 0, 0};
+
+    /// Branch-free equality of two 16-byte keys: one SSE2 compare, or two 64-bit compares without SSE2.
+    /// Pointers need not be 16-byte aligned.
+    static bool equal(const void *lhs, const void *rhs) noexcept
+    {
+#if defined(__SSE2__)
+        const __m128i lhsKey = _mm_loadu_si128(static_cast<const __m128i *>(lhs));
+        const __m128i rhsKey = _mm_loadu_si128(static_cast<const __m128i *>(rhs));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(lhsKey, rhsKey)) == 0xffff;
+#else
+        uint64_t lhsWords[2], rhsWords[2];
+        memcpy(lhsWords, lhs, sizeof(lhsWords));
+        memcpy(rhsWords, rhs, sizeof(rhsWords));
+        return ((lhsWords[0] ^ rhsWords[0]) | (lhsWords[1] ^ rhsWords[1])) == 0;
+#endif
+    }
 
     bool operator==(const FiveTuple &other) const
     {
-        return mSourceAddress == other.mSourceAddress && mDestinationAddress == other.mDestinationAddress &&
-               mSourcePort == other.mSourcePort && mDestinationPort == other.mDestinationPort &&
-               mProtocol == other.mProtocol;
+        return equal(this, &other);
     }
 
     FiveTuple operator!() const
@@ -25,4 +58,29 @@ class FiveTuple
                          .mDestinationPort = mSourcePort,
                          .mProtocol = mProtocol};
     }
+
+    /// Canonical bidirectional form: the lower (address, port) endpoint becomes the source, so both
+    /// directions of a flow yield the same key and any hash of the canonical key is symmetric.
+    /// Meant to be computed once per packet at parse time, the FlowTable overloads taking a canonical key
+    /// and its direction then skip it.
+    /// @param direction set to the direction the packet travels relative to the canonical key
+    FiveTuple canonical(FlowDirection &direction) const
+    {
+        const bool reversed = (mSourceAddress > mDestinationAddress) ||
+                              ((mSourceAddress == mDestinationAddress) && (mSourcePort > mDestinationPort));
+        direction = reversed ? FlowDirection::Reverse : FlowDirection::Forward;
+        return reversed ? !*this : *this;
+    }
+
+    FiveTuple canonical() const
+    {
+        FlowDirection direction;
+        return canonical(direction);
+    }
 };
+
+static_assert(sizeof(FiveTuple) == 16, "FiveTuple must be exactly 16 bytes");
+static_assert(offsetof(FiveTuple, mDestinationAddress) == 4 && offsetof(FiveTuple, mSourcePort) == 8 &&
+                  offsetof(FiveTuple, mDestinationPort) == 10 && offsetof(FiveTuple, mProtocol) == 12,
+              "FiveTuple layout changed");
+static_assert(std::has_unique_object_representations<FiveTuple>::value, "FiveTuple must not have implicit padding");
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// One cache line of the bucketized flow table: SLOTS_COUNT (tag, entry index) pairs and the index of
+/// the overflow extension bucket. Entry index 0 marks an empty slot, extension index 0 ends the chain.
+class alignas(64) FlowBucket
+{
+  public:
+    static constexpr uint32_t SLOTS_COUNT = 12;
+    static constexpr uint32_t SLOTS_MASK = (1u << SLOTS_COUNT) - 1;
+
+    uint8_t mTags[SLOTS_COUNT];
+    uint32_t mNextExtension;
+    uint32_t mEntries[SLOTS_COUNT];
+
+    /// Bitmask of the slots holding `tag`. Empty slots may match too, callers check mEntries.
+    uint32_t match(const uint8_t tag) const noexcept
+    {
+#if defined(__SSE2__)
+        // mTags and mNextExtension are contiguous, so one 16-byte load covers all the tags
+        const __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mTags));
+        const __m128i hits = _mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag)));
+        return static_cast<uint32_t>(_mm_movemask_epi8(hits)) & SLOTS_MASK;
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < SLOTS_COUNT; ++i)
+            mask |= static_cast<uint32_t>(mTags[i] == tag) << i;
+        return mask;
+#endif
+    }
+};
+
+static_assert(sizeof(FlowBucket) == 64, "FlowBucket must fit in exactly one cache line");
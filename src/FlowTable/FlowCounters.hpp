@@ -0,0 +1,77 @@
+#pragma once
+#include "FiveTuple.hpp"
+#include <rte_pause.h>
+#include <stdint.h>
+
+/// Consistent copy of the counters of a flow, indexed by FlowDirection
+class FlowCountersSnapshot
+{
+  public:
+    uint64_t mFirstSeen;
+    uint64_t mLastSeen;
+    uint64_t mPackets[2];
+    uint64_t mBytes[2];
+    uint8_t mTcpFlags[2]; // union of the TCP flags seen
+};
+
+/// Traffic counters of a flow, per direction: Forward is the initiator, the side that sent the first packet.
+/// Only the lcore owning the flow writes them, with plain stores; exporters on other lcores read them
+/// through a sequence counter, retrying while an update is in flight.
+class alignas(64) FlowCounters
+{
+  public:
+    uint32_t mSequence{0}; // odd while the owner updates
+    uint8_t mTcpFlags[2]{0, 0};
+    uint64_t mFirstSeen{0};
+    uint64_t mLastSeen{0};
+    uint64_t mPackets[2]{0, 0};
+    uint64_t mBytes[2]{0, 0};
+
+    /// Owner side, accounts one packet
+    void add(const FlowDirection direction, const uint32_t packetBytes, const uint8_t tcpFlags,
+             const uint64_t now) noexcept
+    {
+        const uint8_t index = static_cast<uint8_t>(direction);
+        const uint32_t sequence = mSequence;
+
+        __atomic_store_n(&mSequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        __atomic_store_n(&mPackets[index], mPackets[index] + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&mBytes[index], mBytes[index] + packetBytes, __ATOMIC_RELAXED);
+        __atomic_store_n(&mTcpFlags[index], static_cast<uint8_t>(mTcpFlags[index] | tcpFlags), __ATOMIC_RELAXED);
+        __atomic_store_n(&mLastSeen, now, __ATOMIC_RELAXED);
+
+        __atomic_store_n(&mSequence, sequence + 2, __ATOMIC_RELEASE);
+    }
+
+    /// Reader side, safe from any lcore while the flow is tracked
+    FlowCountersSnapshot read() const noexcept
+    {
+        FlowCountersSnapshot snapshot;
+        for (;;)
+        {
+            const uint32_t sequence = __atomic_load_n(&mSequence, __ATOMIC_ACQUIRE);
+            if (sequence & 1)
+            {
+                rte_pause();
+                continue;
+            }
+
+            snapshot.mFirstSeen = __atomic_load_n(&mFirstSeen, __ATOMIC_RELAXED);
+            snapshot.mLastSeen = __atomic_load_n(&mLastSeen, __ATOMIC_RELAXED);
+            for (uint8_t index = 0; index < 2; ++index)
+            {
+                snapshot.mPackets[index] = __atomic_load_n(&mPackets[index], __ATOMIC_RELAXED);
+                snapshot.mBytes[index] = __atomic_load_n(&mBytes[index], __ATOMIC_RELAXED);
+                snapshot.mTcpFlags[index] = __atomic_load_n(&mTcpFlags[index], __ATOMIC_RELAXED);
+            }
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&mSequence, __ATOMIC_RELAXED) == sequence)
+                return snapshot;
+        }
+    }
+};
+
+static_assert(sizeof(FlowCounters) == 64, "FlowCounters must fit in exactly one cache line");
@@ -2,77 +2,493 @@
 #include "FiveTuple.hpp"
 #include "TrackBucket.hpp"
 #include "TrackDescriptor.hpp"
+#include "Common/Eviction/EvictionPolicy.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <new>
 #include <rte_malloc.h>
 #include <rte_mempool.h>
-
+#include <rte_prefetch.h>
+#include <rte_random.h>
+#include <rte_rcu_qsbr.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/// Chained hash table of flows keyed by the RSS hash. The head array is sized at runtime: it starts at
+/// MIN_HEAD_SLOTS_COUNT slots and doubles whenever the flows outnumber loadFactor times the slots, up to
+/// what the capacity needs. A resize never stops the world, the chains of the old array move over a
+/// bounded number of slots at a time from find_or_insert() and age(), and lookups meanwhile check both
+/// arrays.
 class FlowTable
 {
-  private:
-    static constexpr int TRACK_DESCRIPTIONS_POOL_SIZE = (1 << 22) - 1;
-    static constexpr int TRACK_BUCKETS_POOL_SIZE = (1 << 22) - 1;
+  public:
+    /// Called for every flow the aging sweeper or a capacity eviction removes, right before it is deleted
+    using ExpireCallback = void (*)(const FiveTuple &fiveTuple, TrackDescriptor *trackDescriptor, void *arg);
+
+    static constexpr uint32_t DEFAULT_CAPACITY = (1 << 22) - 1;
+    static constexpr float DEFAULT_LOAD_FACTOR = 0.25f;
+    static constexpr uint32_t MIN_HEAD_SLOTS_COUNT = 1 << 10;
+    static constexpr uint32_t MAX_HEAD_SLOTS_COUNT = 1 << 24; // the slot is taken from the 24 MSBs of the hash
+    static constexpr uint32_t AGING_SLOTS_PER_CALL = 1024;
+    static constexpr uint32_t EVICTION_SAMPLE_SIZE = 8;
 
+  private:
+    static constexpr uint32_t TRACK_RULES_PER_FLOW_RATIO = 4; // only flows with many rules need a block
+    static constexpr uint32_t MIGRATION_SLOTS_PER_INSERT = 8;
+    static constexpr uint32_t BULK_GROUP_SIZE = 32;
+    static constexpr uint32_t RCU_RECLAIM_TRIGGER = 1024;
+    static constexpr uint32_t RCU_MAX_RECLAIM = 256;
+    static constexpr uint32_t EVICTION_MAX_SLOTS = 1 << 16; // head slots an eviction may scan for a victim
+
+    /// Unlinked entry waiting for the RCU grace period
+    class RetiredTrack
+    {
+      public:
+        TrackBucket *mTrackBucket;
+    };
+
+    std::string m_Name;
+    int m_SocketId;
+    uint32_t m_Capacity;
+    float m_LoadFactor;
     TrackBucket **m_HashBuckets;
-    rte_mempool *m_TrackDescriptorsPool;
+    uint32_t m_SlotsMask;
+    uint32_t m_MaxSlotsMask;
+    uint32_t m_GrowThreshold;
+    // Resize state, the old array is set while its chains migrate to m_HashBuckets
+    TrackBucket **m_OldHashBuckets;
+    uint32_t m_OldSlotsMask;
+    uint32_t m_MigrationCursor;
+    uint32_t m_ResizeSeq;               // odd while the writer moves chains, readers retry a miss on change
+    TrackBucket **m_RetiredHashBuckets; // freed once no reader can still walk it
+    uint64_t m_RetiredHashBucketsToken;
     rte_mempool *m_TrackBucketsPool;
+    rte_mempool *m_TrackRulesPool;
+    rte_rcu_qsbr *m_Rcu;
+    rte_rcu_qsbr_dq *m_RcuDeferQueue;
+    uint64_t m_AgingTtl; // 0 disables aging
+    uint32_t m_AgingCursor;
+    ExpireCallback m_ExpireCallback;
+    void *m_ExpireCallbackArg;
+    uint32_t m_FlowsCount;
+    bool m_TrackLastSeen; // aging or an LRU eviction policy needs mLastSeen
+    EvictionPolicy m_EvictionPolicy;
+    uint32_t m_EvictionHighWatermark;
+    uint32_t m_EvictionSampleSize;
+    uint32_t m_ClockHand;
+    EvictionStats m_EvictionStats;
 
   public:
-    explicit FlowTable()
-        : m_HashBuckets(nullptr)
-        , m_TrackDescriptorsPool(nullptr)
+    /// @param name         unique prefix for the mempool names
+    /// @param capacity     maximum number of tracked flows, sizes the mempools
+    /// @param loadFactor   flows per head slot above which the head array doubles
+    /// @param mempoolCache per-lcore mempool cache size, capped per pool at what rte_mempool accepts for its size
+    /// @param mempoolFlags rte_mempool flags, RTE_MEMPOOL_F_SP_PUT | RTE_MEMPOOL_F_SC_GET for a table owned by
+    ///                     a single lcore
+    /// @param socketId     NUMA socket of the head array and pools, the socket of the lcores using the table
+    explicit FlowTable(const std::string &name = "FlowTable", uint32_t capacity = DEFAULT_CAPACITY,
+                       float loadFactor = DEFAULT_LOAD_FACTOR, unsigned mempoolCache = 0, unsigned mempoolFlags = 0,
+                       int socketId = SOCKET_ID_ANY)
+        : m_Name(name)
+        , m_SocketId(socketId)
+        , m_Capacity(capacity)
+        , m_LoadFactor(loadFactor)
+        , m_HashBuckets(nullptr)
+        , m_SlotsMask(MIN_HEAD_SLOTS_COUNT - 1)
+        , m_MaxSlotsMask(MIN_HEAD_SLOTS_COUNT - 1)
+        , m_GrowThreshold(0)
+        , m_OldHashBuckets(nullptr)
+        , m_OldSlotsMask(0)
+        , m_MigrationCursor(0)
+        , m_ResizeSeq(0)
+        , m_RetiredHashBuckets(nullptr)
+        , m_RetiredHashBucketsToken(0)
         , m_TrackBucketsPool(nullptr)
+        , m_TrackRulesPool(nullptr)
+        , m_Rcu(nullptr)
+        , m_RcuDeferQueue(nullptr)
+        , m_AgingTtl(0)
+        , m_AgingCursor(0)
+        , m_ExpireCallback(nullptr)
+        , m_ExpireCallbackArg(nullptr)
+        , m_FlowsCount(0)
+        , m_TrackLastSeen(false)
+        , m_EvictionPolicy(EvictionPolicy::None)
+        , m_EvictionHighWatermark(capacity - capacity / 16)
+        , m_EvictionSampleSize(EVICTION_SAMPLE_SIZE)
+        , m_ClockHand(0)
     {
-        m_HashBuckets = reinterpret_cast<TrackBucket **>(rte_zmalloc(NULL, sizeof(TrackBucket *) * 1 << 24, 64));
+        if (capacity == 0 || !(loadFactor > 0))
+            throw std::invalid_argument("FlowTable needs a capacity and a positive load factor");
+
+        const std::string trackBucketsPoolName = name + "_tbmp";
+        const std::string trackRulesPoolName = name + "_trmp";
+
+        // Head slots needed at full capacity, the array grows up to there
+        while (m_MaxSlotsMask < MAX_HEAD_SLOTS_COUNT - 1 && (m_MaxSlotsMask + 1) * loadFactor < capacity)
+            m_MaxSlotsMask = (m_MaxSlotsMask << 1) | 1;
+        m_GrowThreshold = growThreshold(m_SlotsMask);
+
+        // Hugepage-backed like the pools, and only as large as the flows tracked so far need
+        m_HashBuckets = reinterpret_cast<TrackBucket **>(
+            rte_zmalloc_socket(NULL, sizeof(TrackBucket *) * (m_SlotsMask + 1), 64, socketId));
         if (m_HashBuckets == nullptr)
         {
             throw std::bad_alloc();
         }
 
-        // Init mempool
-        m_TrackDescriptorsPool = rte_mempool_create("TrackDescriptorsPool", TRACK_DESCRIPTIONS_POOL_SIZE,
-                                                    sizeof(TrackDescriptor), 0, 0, NULL, NULL, NULL, NULL, 0, 0);
-        if (m_TrackDescriptorsPool == nullptr)
+        // Init mempool, track buckets carry the hot descriptor inline
+        m_TrackBucketsPool = rte_mempool_create(trackBucketsPoolName.c_str(), capacity, sizeof(TrackBucket),
+                                                poolCacheSize(mempoolCache, capacity), 0, NULL, NULL, NULL, NULL,
+                                                socketId, mempoolFlags);
+        if (m_TrackBucketsPool == nullptr)
         {
             throw std::bad_alloc();
         }
 
-        m_TrackBucketsPool = rte_mempool_create("TrackBucketsPool", TRACK_BUCKETS_POOL_SIZE, sizeof(TrackBucket), 0, 0,
-                                                NULL, NULL, NULL, NULL, 0, 0);
-        if (m_TrackBucketsPool == nullptr)
+        const uint32_t trackRulesPoolSize = std::max<uint32_t>(capacity / TRACK_RULES_PER_FLOW_RATIO, 1);
+        m_TrackRulesPool = rte_mempool_create(trackRulesPoolName.c_str(), trackRulesPoolSize, sizeof(TrackRules),
+                                              poolCacheSize(mempoolCache, trackRulesPoolSize), 0, NULL, NULL, NULL,
+                                              NULL, socketId, mempoolFlags);
+        if (m_TrackRulesPool == nullptr)
         {
             throw std::bad_alloc();
         }
     }
 
+    /// With RCU attached, waits for the readers to leave the retired entries before freeing them: the
+    /// calling thread must not be an online reader of that RCU.
     ~FlowTable() noexcept
     {
-        if (m_TrackDescriptorsPool)
-            rte_mempool_free(m_TrackDescriptorsPool);
+        if (m_RcuDeferQueue)
+        {
+            // The delete fails while retired entries still wait for their grace period
+            while (rte_rcu_qsbr_dq_delete(m_RcuDeferQueue) != 0)
+                rte_rcu_qsbr_synchronize(m_Rcu, RTE_QSBR_THRID_INVALID);
+        }
+        if (m_RetiredHashBuckets && m_Rcu)
+            rte_rcu_qsbr_synchronize(m_Rcu, RTE_QSBR_THRID_INVALID);
         if (m_TrackBucketsPool)
             rte_mempool_free(m_TrackBucketsPool);
+        if (m_TrackRulesPool)
+            rte_mempool_free(m_TrackRulesPool);
         if (m_HashBuckets)
             rte_free(m_HashBuckets);
+        if (m_OldHashBuckets)
+            rte_free(m_OldHashBuckets);
+        if (m_RetiredHashBuckets)
+            rte_free(m_RetiredHashBuckets);
+    }
+
+    /// Enables lock-free readers. Lookups may then run on any number of reader lcores concurrently with
+    /// one writer (or several writers serialized by the caller): entries are published and unlinked with
+    /// release stores, and deleted entries go back to their mempools only after every reader registered
+    /// with `rcu` has reported a quiescent state. Readers call rte_rcu_qsbr_quiescent() once per burst,
+    /// outside of any lookup.
+    void attach_rcu(rte_rcu_qsbr *rcu)
+    {
+        const std::string deferQueueName = m_Name + "_dq";
+
+        rte_rcu_qsbr_dq_parameters params = {};
+        params.name = deferQueueName.c_str();
+        params.flags = RTE_RCU_QSBR_DQ_MT_UNSAFE; // the writers are serialized
+        params.size = m_Capacity;
+        params.esize = sizeof(RetiredTrack);
+        params.trigger_reclaim_limit = RCU_RECLAIM_TRIGGER;
+        params.max_reclaim_size = RCU_MAX_RECLAIM;
+        params.free_fn = &FlowTable::free_retired;
+        params.p = this;
+        params.v = rcu;
+
+        m_RcuDeferQueue = rte_rcu_qsbr_dq_create(&params);
+        if (m_RcuDeferQueue == nullptr)
+            throw std::bad_alloc();
+        m_Rcu = rcu;
+    }
+
+    /// Writer side: returns the deleted entries whose grace period has elapsed to their mempools.
+    /// Also happens implicitly on delete_entry() once enough entries are pending.
+    void reclaim() noexcept
+    {
+        if (m_RcuDeferQueue)
+            rte_rcu_qsbr_dq_reclaim(m_RcuDeferQueue, RCU_MAX_RECLAIM, nullptr, nullptr, nullptr);
+    }
+
+    /// Enables aging: once enabled, lookups and inserts refresh mLastSeen, and age() evicts the flows
+    /// idle for longer than `ttlCycles`.
+    /// @param ttlCycles      idle timeout in rte_rdtsc() cycles, 0 disables aging
+    /// @param expireCallback optional, called for every evicted flow
+    void set_aging(const uint64_t ttlCycles, ExpireCallback expireCallback = nullptr, void *arg = nullptr) noexcept
+    {
+        m_AgingTtl = ttlCycles;
+        m_ExpireCallback = expireCallback;
+        m_ExpireCallbackArg = arg;
+        updateTrackLastSeen();
+    }
+
+    /// Enables capacity-pressure eviction: once `highWatermark` flows are tracked, inserting a new flow
+    /// first evicts one chosen by `policy`, and an insert that finds the pools empty evicts and retries
+    /// once. Evicted flows go through the expire callback of set_aging(), if any.
+    /// @param highWatermark 0 for 15/16 of the capacity
+    /// @param sampleSize    flows compared by EvictionPolicy::SampledLru
+    void set_eviction(const EvictionPolicy policy, const uint32_t highWatermark = 0,
+                      const uint32_t sampleSize = EVICTION_SAMPLE_SIZE) noexcept
+    {
+        m_EvictionPolicy = policy;
+        m_EvictionHighWatermark = highWatermark ? highWatermark : m_Capacity - m_Capacity / 16;
+        m_EvictionSampleSize = sampleSize ? sampleSize : 1;
+        updateTrackLastSeen();
+    }
+
+    const EvictionStats &evictionStats() const noexcept
+    {
+        return m_EvictionStats;
+    }
+
+    /// NUMA socket the table was allocated on, SOCKET_ID_ANY if none was requested
+    int socket_id() const noexcept
+    {
+        return m_SocketId;
+    }
+
+    /// Number of tracked flows
+    uint32_t size() const noexcept
+    {
+        return m_FlowsCount;
     }
 
-    TrackDescriptor *lookup(const uint32_t hash, const FiveTuple &fiveTuple) noexcept
+    /// Maximum number of tracked flows
+    uint32_t capacity() const noexcept
     {
-        const uint32_t RSS24MSBs = hash >> 8;
+        return m_Capacity;
+    }
 
-        TrackBucket *current_track_bucket = m_HashBuckets[RSS24MSBs];
+    /// Current number of head slots
+    uint32_t slotsCount() const noexcept
+    {
+        return m_SlotsMask + 1;
+    }
 
-        FiveTuple fiveTupleRev = !fiveTuple;
+    /// Whether chains are still migrating from the previous head array
+    bool resizing() const noexcept
+    {
+        return m_OldHashBuckets != nullptr;
+    }
 
-        for (; current_track_bucket; current_track_bucket = current_track_bucket->mNext)
+    /// Incremental aging sweep, meant to be called once per poll iteration by the writer. Walks the next
+    /// `slotsBudget` head slots from where the previous call stopped, so the cost of a call is bounded and
+    /// the whole table is covered every slotsCount() / slotsBudget calls. A pending resize first migrates
+    /// up to `slotsBudget` slots, even with aging disabled.
+    /// @param now may be sampled before the call, e.g. once per poll iteration; flows hit since are kept
+    /// @return number of evicted flows
+    uint32_t age(const uint32_t slotsBudget = AGING_SLOTS_PER_CALL, const uint64_t now = rte_rdtsc())
+    {
+        migrate(slotsBudget);
+        if (m_AgingTtl == 0)
+            return 0;
+
+        uint32_t evicted = 0;
+        for (uint32_t i = 0; i < slotsBudget; ++i)
         {
-            if ((current_track_bucket->mRSS8LSBs == (hash & 0xff)) &&
-                ((current_track_bucket->mFiveTuple == fiveTuple) || (current_track_bucket->mFiveTuple == fiveTupleRev)))
+            const uint32_t slot = m_AgingCursor;
+            m_AgingCursor = (m_AgingCursor + 1) & m_SlotsMask;
+
+            TrackBucket *current_track_bucket = m_HashBuckets[slot];
+            while (current_track_bucket)
             {
-                return current_track_bucket->mTrackDescriptor;
+                TrackBucket *next_track_bucket = current_track_bucket->mNext;
+                TrackDescriptor *trackDescriptor = &current_track_bucket->mTrackDescriptor;
+
+                // A flow hit after `now` was sampled is not idle, the unsigned difference would wrap
+                const uint64_t lastSeen = __atomic_load_n(&trackDescriptor->mLastSeen, __ATOMIC_RELAXED);
+                if (lastSeen < now && now - lastSeen > m_AgingTtl)
+                {
+                    if (m_ExpireCallback)
+                        m_ExpireCallback(current_track_bucket->mFiveTuple, trackDescriptor, m_ExpireCallbackArg);
+                    delete_entry(current_track_bucket->mHash, trackDescriptor);
+                    ++evicted;
+                }
+                current_track_bucket = next_track_bucket;
             }
         }
 
-        return nullptr;
+        return evicted;
+    }
+
+    /// @param direction optional, set to the direction of the packet relative to the first packet of the
+    ///                  flow, Forward on a miss since the packet would initiate the flow
+    TrackDescriptor *lookup(const uint32_t hash, const FiveTuple &fiveTuple,
+                            FlowDirection *direction = nullptr) noexcept
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = fiveTuple.canonical(packetDirection);
+        return lookup(hash, canonicalFiveTuple, packetDirection, direction);
+    }
+
+    /// lookup() of a key the parse path already canonicalized
+    /// @param canonicalFiveTuple FiveTuple::canonical() of the packet five tuple
+    /// @param packetDirection    direction FiveTuple::canonical() returned along with it
+    TrackDescriptor *lookup(const uint32_t hash, const FiveTuple &canonicalFiveTuple,
+                            const FlowDirection packetDirection, FlowDirection *direction = nullptr) noexcept
+    {
+        TrackBucket *trackBucket = locate(hash, canonicalFiveTuple);
+        if (trackBucket == nullptr)
+        {
+            if (direction)
+                *direction = FlowDirection::Forward;
+            return nullptr;
+        }
+
+        if (direction)
+            *direction = trackBucket->mTrackDescriptor.direction(packetDirection);
+
+        touch(trackBucket, m_TrackLastSeen ? rte_rdtsc() : 0);
+        return &trackBucket->mTrackDescriptor;
+    }
+
+    /// Read-only lookup() for an lcore that does not own the table, such as a ShardedFlowTable::lookup_any()
+    /// probe of a foreign shard. It does not touch the flow, so the aging and eviction state stay the
+    /// owner's. The caller must not account or modify the descriptor. Concurrent with the owner only in RCU
+    /// mode.
+    TrackDescriptor *probe(const uint32_t hash, const FiveTuple &canonicalFiveTuple,
+                           const FlowDirection packetDirection, FlowDirection *direction = nullptr) const noexcept
+    {
+        TrackBucket *trackBucket = locate(hash, canonicalFiveTuple);
+        if (trackBucket == nullptr)
+        {
+            if (direction)
+                *direction = FlowDirection::Forward;
+            return nullptr;
+        }
+
+        if (direction)
+            *direction = trackBucket->mTrackDescriptor.direction(packetDirection);
+        return &trackBucket->mTrackDescriptor;
+    }
+
+    /// lookup() that also accounts the packet to the flow, in the direction the packet matched it in
+    /// @param tcpFlags TCP flags of the packet, 0 for other protocols
+    TrackDescriptor *lookup_and_account(const uint32_t hash, const FiveTuple &fiveTuple, const uint32_t packetBytes,
+                                        const uint8_t tcpFlags = 0, FlowDirection *direction = nullptr) noexcept
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = fiveTuple.canonical(packetDirection);
+        return lookup_and_account(hash, canonicalFiveTuple, packetDirection, packetBytes, tcpFlags, direction);
+    }
+
+    /// lookup_and_account() of a key the parse path already canonicalized
+    TrackDescriptor *lookup_and_account(const uint32_t hash, const FiveTuple &canonicalFiveTuple,
+                                        const FlowDirection packetDirection, const uint32_t packetBytes,
+                                        const uint8_t tcpFlags = 0, FlowDirection *direction = nullptr) noexcept
+    {
+        FlowDirection flowDirection;
+        TrackDescriptor *trackDescriptor = lookup(hash, canonicalFiveTuple, packetDirection, &flowDirection);
+        if (direction)
+            *direction = flowDirection;
+        if (trackDescriptor != nullptr)
+            account(trackDescriptor, flowDirection, packetBytes, tcpFlags);
+
+        return trackDescriptor;
+    }
+
+    /// Accounts a packet to a flow already looked up, e.g. with the directions filled by lookup_bulk().
+    /// Only the lcore owning the table may call it.
+    static void account(TrackDescriptor *trackDescriptor, const FlowDirection direction, const uint32_t packetBytes,
+                        const uint8_t tcpFlags = 0, const uint64_t now = rte_rdtsc()) noexcept
+    {
+        TrackBucket::of(trackDescriptor)->mCounters.add(direction, packetBytes, tcpFlags, now);
+    }
+
+    /// Consistent copy of the counters of a flow, from any lcore: an exporter walking the flows under
+    /// RCU, or the expire callback
+    static FlowCountersSnapshot counters(const TrackDescriptor *trackDescriptor) noexcept
+    {
+        return TrackBucket::of(trackDescriptor)->mCounters.read();
+    }
+
+    /// Burst variant of lookup(). The burst is resolved in groups of BULK_GROUP_SIZE: first the head
+    /// slots of the whole group are prefetched, then the first track bucket of every chain, and only
+    /// then the chains are walked, so the dependent cache misses of the group overlap. While a resize is
+    /// pending, a miss falls back to lookup() over both head arrays.
+    /// @param hashes RSS hash of each packet
+    /// @param keys   five tuple of each packet
+    /// @param out    filled with the matching track descriptor, or nullptr on a miss
+    /// @param directions optional, filled with the direction of each packet as lookup() reports it
+    /// @return number of hits
+    uint32_t lookup_bulk(const uint32_t *hashes, const FiveTuple *keys, TrackDescriptor **out, const uint32_t n,
+                         FlowDirection *directions = nullptr) noexcept
+    {
+        FiveTuple canonicalKeys[BULK_GROUP_SIZE];
+        FlowDirection packetDirections[BULK_GROUP_SIZE];
+        uint32_t hits = 0;
+
+        for (uint32_t base = 0; base < n; base += BULK_GROUP_SIZE)
+        {
+            const uint32_t count = (n - base < BULK_GROUP_SIZE) ? (n - base) : BULK_GROUP_SIZE;
+            for (uint32_t i = 0; i < count; ++i)
+                canonicalKeys[i] = keys[base + i].canonical(packetDirections[i]);
+            hits += lookup_bulk(hashes + base, canonicalKeys, packetDirections, out + base, count,
+                                directions ? directions + base : nullptr);
+        }
+
+        return hits;
+    }
+
+    /// lookup_bulk() of keys the parse path already canonicalized
+    /// @param canonicalKeys    FiveTuple::canonical() of each packet five tuple
+    /// @param packetDirections direction FiveTuple::canonical() returned for each packet
+    uint32_t lookup_bulk(const uint32_t *hashes, const FiveTuple *canonicalKeys, const FlowDirection *packetDirections,
+                         TrackDescriptor **out, const uint32_t n, FlowDirection *directions = nullptr) noexcept
+    {
+        TrackBucket *heads[BULK_GROUP_SIZE];
+        const uint64_t now = m_TrackLastSeen ? rte_rdtsc() : 0; // one timestamp per burst
+        uint32_t hits = 0;
+
+        for (uint32_t base = 0; base < n; base += BULK_GROUP_SIZE)
+        {
+            const uint32_t count = (n - base < BULK_GROUP_SIZE) ? (n - base) : BULK_GROUP_SIZE;
+
+            // One snapshot of the geometry per group, a stale mask only ever indexes within the array
+            const uint32_t resizeSeq = __atomic_load_n(&m_ResizeSeq, __ATOMIC_ACQUIRE);
+            const uint32_t slotsMask = __atomic_load_n(&m_SlotsMask, __ATOMIC_ACQUIRE);
+            TrackBucket **hashBuckets = __atomic_load_n(&m_HashBuckets, __ATOMIC_ACQUIRE);
+
+            // Stage 1: prefetch the head slots
+            for (uint32_t i = 0; i < count; ++i)
+                rte_prefetch0(&hashBuckets[(hashes[base + i] >> 8) & slotsMask]);
+
+            // Stage 2: load the heads and prefetch the first track bucket of each chain
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                heads[i] = __atomic_load_n(&hashBuckets[(hashes[base + i] >> 8) & slotsMask], __ATOMIC_ACQUIRE);
+                if (heads[i] != nullptr)
+                    rte_prefetch0(heads[i]);
+            }
+
+            // Stage 3: walk the chains, the descriptor shares the line of its track bucket
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                TrackBucket *trackBucket = find(heads[i], hashes[base + i], canonicalKeys[base + i]);
+                if (trackBucket == nullptr && (__atomic_load_n(&m_OldHashBuckets, __ATOMIC_RELAXED) != nullptr ||
+                                               resizeRaced(resizeSeq)))
+                    trackBucket = locate(hashes[base + i], canonicalKeys[base + i]);
+
+                TrackDescriptor *trackDescriptor = nullptr;
+                if (trackBucket != nullptr)
+                {
+                    trackDescriptor = &trackBucket->mTrackDescriptor;
+                    touch(trackBucket, now);
+                    ++hits;
+                }
+                if (directions)
+                    directions[base + i] = trackDescriptor ? trackDescriptor->direction(packetDirections[base + i])
+                                                           : FlowDirection::Forward;
+                out[base + i] = trackDescriptor;
+            }
+        }
+
+        return hits;
     }
 
     bool delete_entry(const uint32_t hash, TrackDescriptor *trackDescriptor)
@@ -80,107 +496,413 @@ class FlowTable
         if (trackDescriptor == nullptr)
             return false;
 
-        const uint32_t RSS24MSBs = hash >> 8;
+        if (unlink(&m_HashBuckets[(hash >> 8) & m_SlotsMask], trackDescriptor))
+            return true;
 
-        TrackBucket *trackBucket = trackDescriptor->mParentTrackBucket;
+        // Not migrated yet
+        return m_OldHashBuckets != nullptr &&
+               unlink(&m_OldHashBuckets[(hash >> 8) & m_OldSlotsMask], trackDescriptor);
+    }
 
-        if (trackBucket == nullptr)
-            [[unlikely]] return false;
+    /// Stores `matchedRuleId` as the first matched rule, the verdict of the flow
+    bool insert(const uint32_t hash, const FiveTuple &packetFiveTuple, const uint16_t matchedRuleId)
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = packetFiveTuple.canonical(packetDirection);
+        return insert(hash, canonicalFiveTuple, packetDirection, matchedRuleId);
+    }
+
+    /// insert() of a key the parse path already canonicalized, e.g. after a lookup() miss
+    bool insert(const uint32_t hash, const FiveTuple &canonicalFiveTuple, const FlowDirection packetDirection,
+                const uint16_t matchedRuleId)
+    {
+        return find_or_insert(hash, canonicalFiveTuple, packetDirection,
+                              [matchedRuleId](TrackDescriptor &trackDescriptor) {
+                                  trackDescriptor.add_rule(
+                                      std::make_tuple(matchedRuleId, static_cast<uint16_t>(100)), nullptr);
+                              })
+                   .first != nullptr;
+    }
+
+    /// Appends a matched rule to the flow, past the inline ones it spills to a pooled overflow block.
+    /// Only meant for classification changes, the per-packet path sticks to the hot descriptor.
+    /// @return false once the flow holds TrackDescriptor::RULES_CAPACITY rules or the pool is exhausted
+    bool add_matched_rule(TrackDescriptor *trackDescriptor, const uint16_t matchedRuleId, const uint16_t value = 100)
+    {
+        return trackDescriptor->add_rule(std::make_tuple(matchedRuleId, value), m_TrackRulesPool);
+    }
+
+    /// Upsert in a single chain walk: returns the descriptor of the flow, inserting it first if needed.
+    /// Also migrates up to MIGRATION_SLOTS_PER_INSERT slots of a pending resize, and starts the next
+    /// resize once the load factor is exceeded.
+    /// @param init      called as init(TrackDescriptor &) on a new descriptor before it is published, with
+    ///                  mLastSeen already set, mFlags holding the origin of the flow and the other fields
+    ///                  zeroed, to initialize them in place. The counters of the flow start at zero, first
+    ///                  seen now. The packet that inserts the flow is its initiator, Forward.
+    /// @param direction optional, set to the direction of the packet relative to the first packet of the flow
+    /// @return the descriptor, nullptr if the flow could not be inserted, and whether it was inserted
+    template <typename Init>
+    std::pair<TrackDescriptor *, bool> find_or_insert(const uint32_t hash, const FiveTuple &packetFiveTuple,
+                                                      Init &&init, FlowDirection *direction = nullptr)
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = packetFiveTuple.canonical(packetDirection);
+        return find_or_insert(hash, canonicalFiveTuple, packetDirection, std::forward<Init>(init), direction);
+    }
+
+    /// find_or_insert() of a key the parse path already canonicalized
+    /// @param canonicalFiveTuple FiveTuple::canonical() of the packet five tuple
+    /// @param packetDirection    direction FiveTuple::canonical() returned along with it
+    template <typename Init>
+    std::pair<TrackDescriptor *, bool> find_or_insert(const uint32_t hash, const FiveTuple &fiveTuple,
+                                                      const FlowDirection packetDirection, Init &&init,
+                                                      FlowDirection *direction = nullptr)
+    {
+        migrate(MIGRATION_SLOTS_PER_INSERT);
+
+        TrackBucket *trackBucket = locate(hash, fiveTuple);
+        if (trackBucket != nullptr)
+        {
+            touch(trackBucket, m_TrackLastSeen ? rte_rdtsc() : 0);
+            if (direction)
+                *direction = trackBucket->mTrackDescriptor.direction(packetDirection);
+            return {&trackBucket->mTrackDescriptor, false};
+        }
 
-        // If the track bucket is the first in the list
-        if (trackBucket->mPrev == nullptr)
+        if (direction)
+            *direction = FlowDirection::Forward;
+
+        if (m_EvictionPolicy != EvictionPolicy::None && m_FlowsCount >= m_EvictionHighWatermark)
+            evict(hash);
+
+        TrackBucket *newTrackBucketPtr = nullptr;
+
+        if (rte_mempool_get(m_TrackBucketsPool, (void **)&newTrackBucketPtr) != 0)
         {
-            // If the track bucket is the only one in the list
-            if (trackBucket->mNext == nullptr)
+            // The pool can run dry below the watermark, e.g. while deletions wait for their grace period
+            const bool evicted = (m_EvictionPolicy != EvictionPolicy::None) && evict(hash);
+            if (evicted)
+                reclaim();
+            if (!evicted || rte_mempool_get(m_TrackBucketsPool, (void **)&newTrackBucketPtr) != 0)
             {
-                m_HashBuckets[RSS24MSBs] = nullptr;
+                ++m_EvictionStats.mInsertFailures;
+                return {nullptr, false};
             }
-            else
+        }
+
+        // New flows go to the head of the chain in the current array, eviction may have just changed it
+        TrackBucket **head = &m_HashBuckets[(hash >> 8) & m_SlotsMask];
+        const uint64_t now = rte_rdtsc();
+        const uint8_t originFlags = TrackDescriptor::origin_flags(packetDirection);
+        new (newTrackBucketPtr) TrackBucket{.mFiveTuple = fiveTuple,
+                                            .mNext = *head,
+                                            .mHash = hash,
+                                            .mReferenced = 0,
+                                            .mTrackDescriptor = {.mLastSeen = now,
+                                                                 .mPackets = 0,
+                                                                 .mFlags = originFlags,
+                                                                 .mRulesCount = 0,
+                                                                 .mInlineRules = {},
+                                                                 .mRules = nullptr},
+                                            .mCounters = {}};
+        newTrackBucketPtr->mCounters.mFirstSeen = now;
+        newTrackBucketPtr->mCounters.mLastSeen = now;
+        TrackDescriptor *newTrackDescriptor = &newTrackBucketPtr->mTrackDescriptor;
+        init(*newTrackDescriptor);
+
+        // Publish only once the track bucket and descriptor are fully built
+        __atomic_store_n(head, newTrackBucketPtr, __ATOMIC_RELEASE);
+        ++m_FlowsCount;
+
+        if (m_FlowsCount > m_GrowThreshold)
+            grow();
+
+        return {newTrackDescriptor, true};
+    }
+
+  private:
+    /// Track buckets store the canonical five tuple, so a single compare per node is enough
+    static TrackBucket *find(TrackBucket *current_track_bucket, const uint32_t hash,
+                             const FiveTuple &canonicalFiveTuple) noexcept
+    {
+        for (; current_track_bucket;
+             current_track_bucket = __atomic_load_n(&current_track_bucket->mNext, __ATOMIC_ACQUIRE))
+        {
+            if ((current_track_bucket->mHash == hash) &&
+                (current_track_bucket->mFiveTuple == canonicalFiveTuple))
             {
-                m_HashBuckets[RSS24MSBs] = trackBucket->mNext;
-                trackBucket->mNext->mPrev = nullptr;
+                return current_track_bucket;
             }
         }
-        else
+
+        return nullptr;
+    }
+
+    /// Walks the chain of the current head array, then the one of the old array during a resize. A miss
+    /// that raced with the writer moving chains is retried, a hit is always genuine.
+    TrackBucket *locate(const uint32_t hash, const FiveTuple &canonicalFiveTuple) const noexcept
+    {
+        for (;;)
         {
-            trackBucket->mPrev->mNext = trackBucket->mNext;
-            if (trackBucket->mNext != nullptr)
-                trackBucket->mNext->mPrev = trackBucket->mPrev;
+            const uint32_t resizeSeq = __atomic_load_n(&m_ResizeSeq, __ATOMIC_ACQUIRE);
+
+            // Mask before array: the array is never smaller than the mask read
+            const uint32_t slotsMask = __atomic_load_n(&m_SlotsMask, __ATOMIC_ACQUIRE);
+            TrackBucket **hashBuckets = __atomic_load_n(&m_HashBuckets, __ATOMIC_ACQUIRE);
+            TrackBucket *trackBucket = find(__atomic_load_n(&hashBuckets[(hash >> 8) & slotsMask], __ATOMIC_ACQUIRE),
+                                            hash, canonicalFiveTuple);
+
+            TrackBucket **oldHashBuckets = __atomic_load_n(&m_OldHashBuckets, __ATOMIC_ACQUIRE);
+            if (trackBucket == nullptr && oldHashBuckets != nullptr)
+            {
+                const uint32_t oldSlotsMask = __atomic_load_n(&m_OldSlotsMask, __ATOMIC_RELAXED);
+                trackBucket = find(__atomic_load_n(&oldHashBuckets[(hash >> 8) & oldSlotsMask], __ATOMIC_ACQUIRE),
+                                   hash, canonicalFiveTuple);
+            }
+
+            if (trackBucket != nullptr || !resizeRaced(resizeSeq))
+                return trackBucket;
         }
-        rte_mempool_put(m_TrackDescriptorsPool, trackDescriptor);
-        rte_mempool_put(m_TrackBucketsPool, trackBucket);
-        return true;
     }
 
-    bool insert(const uint32_t hash, const FiveTuple &fiveTuple, const uint16_t matchedRuleId)
+    /// Whether the writer moved chains since `resizeSeq` was read, or is moving them
+    bool resizeRaced(const uint32_t resizeSeq) const noexcept
     {
-        const uint32_t RSS24MSBs = hash >> 8;
-        const uint8_t RSS8LSBs = hash & 0xff;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return (resizeSeq & 1) || __atomic_load_n(&m_ResizeSeq, __ATOMIC_RELAXED) != resizeSeq;
+    }
 
-        TrackBucket *current_track_bucket = m_HashBuckets[RSS24MSBs];
+    void beginResize() noexcept
+    {
+        __atomic_store_n(&m_ResizeSeq, m_ResizeSeq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
 
-        if (current_track_bucket == nullptr) // insert new track bucket + track descriptor
-        {
-            TrackBucket *newTrackBucketPtr = nullptr;
-            TrackDescriptor *newTrackDescriptor = nullptr;
+    void endResize() noexcept
+    {
+        __atomic_store_n(&m_ResizeSeq, m_ResizeSeq + 1, __ATOMIC_RELEASE);
+    }
 
-            if (rte_mempool_get(m_TrackDescriptorsPool, (void **)&newTrackDescriptor) != 0)
-                return false;
-            if (rte_mempool_get(m_TrackBucketsPool, (void **)&newTrackBucketPtr) != 0)
-                return false;
+    /// rte_mempool rejects a cache whose flush threshold, 1.5 times its size, exceeds the pool size
+    static unsigned poolCacheSize(const unsigned mempoolCache, const uint32_t poolSize) noexcept
+    {
+        return std::min<unsigned>(mempoolCache, static_cast<unsigned>(uint64_t{poolSize} * 2 / 3));
+    }
 
-            new (newTrackDescriptor) TrackDescriptor{.mParentTrackBucket = newTrackBucketPtr,
-                                                     .mLastSeen = rte_rdtsc(),
-                                                     .mMatchedRules = {std::make_pair(matchedRuleId, 100)}};
+    uint32_t growThreshold(const uint32_t slotsMask) const noexcept
+    {
+        if (slotsMask >= m_MaxSlotsMask)
+            return UINT32_MAX;
+        return static_cast<uint32_t>(m_LoadFactor * (static_cast<float>(slotsMask) + 1));
+    }
 
-            new (newTrackBucketPtr) TrackBucket{.mFiveTuple = fiveTuple,
-                                                .mPrev = nullptr,
-                                                .mNext = nullptr,
-                                                .mTrackDescriptor = newTrackDescriptor,
-                                                .mRSS8LSBs = RSS8LSBs};
+    /// Starts doubling the head array. Slot s of the old array splits into slots s and s + old size of the
+    /// new one, migrate() then moves the chains over.
+    void grow()
+    {
+        if (m_OldHashBuckets != nullptr || !reclaimHashBuckets())
+            return;
+
+        const uint32_t slotsMask = (m_SlotsMask << 1) | 1;
+        auto **hashBuckets = reinterpret_cast<TrackBucket **>(
+            rte_zmalloc_socket(NULL, sizeof(TrackBucket *) * (slotsMask + 1), 64, m_SocketId));
+        if (hashBuckets == nullptr)
+            return; // keep running with longer chains, the next insert retries
+
+        // Old array before new array, and new array before its mask
+        beginResize();
+        __atomic_store_n(&m_OldSlotsMask, m_SlotsMask, __ATOMIC_RELAXED);
+        __atomic_store_n(&m_OldHashBuckets, m_HashBuckets, __ATOMIC_RELEASE);
+        __atomic_store_n(&m_HashBuckets, hashBuckets, __ATOMIC_RELEASE);
+        __atomic_store_n(&m_SlotsMask, slotsMask, __ATOMIC_RELEASE);
+        endResize();
+
+        m_MigrationCursor = 0;
+        m_GrowThreshold = growThreshold(slotsMask);
+    }
 
-            m_HashBuckets[RSS24MSBs] = newTrackBucketPtr;
-            return true;
+    /// Moves the chains of up to `slotsBudget` old head slots into the current array. Track buckets are
+    /// relinked in place, so descriptors keep their address.
+    void migrate(const uint32_t slotsBudget)
+    {
+        if (m_OldHashBuckets == nullptr)
+        {
+            reclaimHashBuckets();
+            return;
         }
 
-        FiveTuple fiveTupleRev = !fiveTuple;
-
-        // Traverse the linked list of track buckets to find a matching bucket
-        // based on RSS8LSBs and FiveTuple. If found, return the associated track descriptor.
-        for (; current_track_bucket; current_track_bucket = current_track_bucket->mNext)
+        beginResize();
+        for (uint32_t i = 0; i < slotsBudget && m_MigrationCursor <= m_OldSlotsMask; ++i, ++m_MigrationCursor)
         {
-            if ((current_track_bucket->mRSS8LSBs == RSS8LSBs) &&
-                ((current_track_bucket->mFiveTuple == fiveTuple) || (current_track_bucket->mFiveTuple == fiveTupleRev)))
+            TrackBucket *trackBucket = m_OldHashBuckets[m_MigrationCursor];
+            while (trackBucket)
             {
-                return current_track_bucket->mTrackDescriptor;
+                TrackBucket *nextTrackBucket = trackBucket->mNext;
+                TrackBucket **head = &m_HashBuckets[(trackBucket->mHash >> 8) & m_SlotsMask];
+                __atomic_store_n(&trackBucket->mNext, *head, __ATOMIC_RELEASE);
+                __atomic_store_n(head, trackBucket, __ATOMIC_RELEASE);
+                trackBucket = nextTrackBucket;
             }
+            __atomic_store_n(&m_OldHashBuckets[m_MigrationCursor], nullptr, __ATOMIC_RELEASE);
+        }
+        endResize();
+
+        if (m_MigrationCursor <= m_OldSlotsMask)
+            return;
+
+        // Readers may still hold the old array, free it after a grace period
+        m_RetiredHashBuckets = m_OldHashBuckets;
+        __atomic_store_n(&m_OldHashBuckets, nullptr, __ATOMIC_RELEASE);
+        if (m_Rcu)
+            m_RetiredHashBucketsToken = rte_rcu_qsbr_start(m_Rcu);
+        reclaimHashBuckets();
+    }
+
+    /// @return false while the head array replaced by the last resize is still in its grace period
+    bool reclaimHashBuckets() noexcept
+    {
+        if (m_RetiredHashBuckets == nullptr)
+            return true;
+        if (m_Rcu && rte_rcu_qsbr_check(m_Rcu, m_RetiredHashBucketsToken, false) != 1)
+            return false;
+
+        rte_free(m_RetiredHashBuckets);
+        m_RetiredHashBuckets = nullptr;
+        return true;
+    }
 
-            // We reached the last element in the list
-            if (current_track_bucket->mNext == nullptr)
-                break;
+    /// Chains are singly linked and short, finds the link pointing at the track bucket and unlinks it
+    bool unlink(TrackBucket **link, const TrackDescriptor *trackDescriptor)
+    {
+        for (; *link; link = &(*link)->mNext)
+        {
+            TrackBucket *trackBucket = *link;
+            if (&trackBucket->mTrackDescriptor != trackDescriptor)
+                continue;
+
+            // The unlinked track bucket keeps its mNext, so readers standing on it can finish their walk
+            __atomic_store_n(link, trackBucket->mNext, __ATOMIC_RELEASE);
+            retire(trackBucket);
+            --m_FlowsCount;
+            return true;
         }
 
-        // if no track bucket found, insert new track bucket + track descriptor
-        TrackBucket *newTrackBucketPtr = nullptr;
-        TrackDescriptor *newTrackDescriptor = nullptr;
+        return false;
+    }
 
-        if (rte_mempool_get(m_TrackDescriptorsPool, (void **)&newTrackDescriptor) != 0)
+    void updateTrackLastSeen() noexcept
+    {
+        m_TrackLastSeen = m_AgingTtl != 0 || m_EvictionPolicy == EvictionPolicy::OldestInBucket ||
+                          m_EvictionPolicy == EvictionPolicy::SampledLru;
+    }
+
+    /// Records a hit on the flow for aging and eviction
+    void touch(TrackBucket *trackBucket, const uint64_t now) const noexcept
+    {
+        if (m_TrackLastSeen)
+            trackBucket->mTrackDescriptor.mLastSeen = now;
+        if (m_EvictionPolicy == EvictionPolicy::Clock)
+            trackBucket->mReferenced = 1;
+    }
+
+    /// Evicts one flow according to the eviction policy, `hash` is the hash of the flow being inserted
+    bool evict(const uint32_t hash)
+    {
+        TrackBucket *victim = nullptr;
+
+        switch (m_EvictionPolicy)
+        {
+        case EvictionPolicy::Clock:
+            victim = clockVictim();
+            break;
+        case EvictionPolicy::OldestInBucket:
+            victim = oldestVictim((hash >> 8) & m_SlotsMask, 1);
+            break;
+        case EvictionPolicy::SampledLru:
+            victim = oldestVictim(static_cast<uint32_t>(rte_rand()) & m_SlotsMask, m_EvictionSampleSize);
+            break;
+        default:
             return false;
-        if (rte_mempool_get(m_TrackBucketsPool, (void **)&newTrackBucketPtr) != 0)
+        }
+
+        if (victim == nullptr)
+        {
+            ++m_EvictionStats.mEvictionMisses;
             return false;
+        }
 
-        new (newTrackDescriptor) TrackDescriptor{.mParentTrackBucket = newTrackBucketPtr,
-                                                 .mLastSeen = rte_rdtsc(),
-                                                 .mMatchedRules = {std::make_pair(matchedRuleId, 100)}};
+        if (m_ExpireCallback)
+            m_ExpireCallback(victim->mFiveTuple, &victim->mTrackDescriptor, m_ExpireCallbackArg);
+        delete_entry(victim->mHash, &victim->mTrackDescriptor);
+        ++m_EvictionStats.mEvictions;
+        return true;
+    }
 
-        new (newTrackBucketPtr) TrackBucket{.mFiveTuple = fiveTuple,
-                                            .mPrev = current_track_bucket,
-                                            .mNext = nullptr,
-                                            .mTrackDescriptor = newTrackDescriptor,
-                                            .mRSS8LSBs = RSS8LSBs};
+    /// Least recently seen flow among the whole chains walked from `startSlot` until `sampleSize` flows
+    /// were seen. With a sample of 1 that is the oldest flow of the first non-empty chain. Chains not yet
+    /// migrated by a resize are not sampled.
+    TrackBucket *oldestVictim(const uint32_t startSlot, const uint32_t sampleSize) const noexcept
+    {
+        TrackBucket *victim = nullptr;
+        uint32_t sampled = 0;
 
-        current_track_bucket->mNext = newTrackBucketPtr;
+        for (uint32_t i = 0; i < EVICTION_MAX_SLOTS && sampled < sampleSize; ++i)
+        {
+            const uint32_t slot = (startSlot + i) & m_SlotsMask;
+            for (TrackBucket *trackBucket = m_HashBuckets[slot]; trackBucket; trackBucket = trackBucket->mNext)
+            {
+                if (victim == nullptr || trackBucket->mTrackDescriptor.mLastSeen < victim->mTrackDescriptor.mLastSeen)
+                    victim = trackBucket;
+                ++sampled;
+            }
+        }
 
-        return true;
+        return victim;
+    }
+
+    /// Advances the CLOCK hand over the head slots, clearing reference bits, up to the first flow not hit
+    /// since the previous pass. The hand stays on the victim's slot so the rest of its chain is next.
+    TrackBucket *clockVictim() noexcept
+    {
+        for (uint32_t i = 0; i < EVICTION_MAX_SLOTS; ++i)
+        {
+            for (TrackBucket *trackBucket = m_HashBuckets[m_ClockHand]; trackBucket; trackBucket = trackBucket->mNext)
+            {
+                if (trackBucket->mReferenced == 0)
+                    return trackBucket;
+                trackBucket->mReferenced = 0;
+            }
+            m_ClockHand = (m_ClockHand + 1) & m_SlotsMask;
+        }
+
+        return nullptr;
+    }
+
+    void retire(TrackBucket *trackBucket) noexcept
+    {
+        RetiredTrack retiredTrack{.mTrackBucket = trackBucket};
+        if (m_RcuDeferQueue == nullptr)
+        {
+            free_retired(this, &retiredTrack, 1);
+            return;
+        }
+
+        if (rte_rcu_qsbr_dq_enqueue(m_RcuDeferQueue, &retiredTrack) != 0)
+        {
+            // Defer queue is full even after reclaiming, wait for the grace period right here
+            rte_rcu_qsbr_synchronize(m_Rcu, RTE_QSBR_THRID_INVALID);
+            free_retired(this, &retiredTrack, 1);
+        }
+    }
+
+    static void free_retired(void *flowTable, void *retiredTracks, unsigned int n)
+    {
+        auto *self = static_cast<FlowTable *>(flowTable);
+        auto *retired = static_cast<RetiredTrack *>(retiredTracks);
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            retired[i].mTrackBucket->mTrackDescriptor.release_rules(self->m_TrackRulesPool);
+            rte_mempool_put(self->m_TrackBucketsPool, retired[i].mTrackBucket);
+        }
     }
 };
@@ -0,0 +1,222 @@
+#pragma once
+#include "FlowTable.hpp"
+#include <cstdint>
+#include <memory>
+#include <rte_lcore.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// FlowTable split into one shard per worker lcore. Shards are indexed by the NIC RX queue the worker
+/// polls: with a symmetric RSS key both directions of a flow land on the same queue, so a flow only ever
+/// touches the shard of the lcore polling that queue. Every shard has its own head array and
+/// single-producer/single-consumer mempools with a per-lcore cache, so the fast path takes no locks and
+/// no atomics.
+///
+/// Given the lcore polling every queue, each shard is allocated on the NUMA socket of its lcore. A shard
+/// read from another socket, a misrouted queue or a lookup_any() probe, is counted as a cross-node access.
+class ShardedFlowTable
+{
+  private:
+    static constexpr unsigned SHARD_MEMPOOL_CACHE = 256;
+
+    class alignas(64) Shard
+    {
+      public:
+        std::unique_ptr<FlowTable> mFlowTable;
+        int mSocketId;
+        uint64_t mCrossShardLookups; // only written by the owner lcore
+        uint64_t mCrossShardHits;
+        uint64_t mCrossNodeLookups;
+        uint64_t mCrossNodeHits;
+    };
+
+    std::vector<Shard> m_Shards;
+
+    void createShard(const uint16_t queueId, const std::string &name, const uint32_t shardCapacity, const int socketId)
+    {
+        Shard &shard = m_Shards[queueId];
+        shard.mFlowTable = std::make_unique<FlowTable>(name + std::to_string(queueId), shardCapacity,
+                                                       FlowTable::DEFAULT_LOAD_FACTOR, SHARD_MEMPOOL_CACHE,
+                                                       RTE_MEMPOOL_F_SP_PUT | RTE_MEMPOOL_F_SC_GET, socketId);
+        shard.mSocketId = socketId;
+        shard.mCrossShardLookups = 0;
+        shard.mCrossShardHits = 0;
+        shard.mCrossNodeLookups = 0;
+        shard.mCrossNodeHits = 0;
+    }
+
+    /// Whether the calling lcore reads the shard of `queueId` from a remote socket
+    bool isRemote(const uint16_t queueId) const noexcept
+    {
+        const int socketId = m_Shards[queueId].mSocketId;
+        return socketId != SOCKET_ID_ANY && socketId != static_cast<int>(rte_socket_id());
+    }
+
+    /// Counts a lookup of the shard of `queueId` issued from the lcore polling `localQueueId`
+    void countNodeAccess(const uint16_t localQueueId, const uint16_t queueId, const uint32_t lookups,
+                         const uint32_t hits) noexcept
+    {
+        if (!isRemote(queueId))
+            return;
+
+        m_Shards[localQueueId].mCrossNodeLookups += lookups;
+        m_Shards[localQueueId].mCrossNodeHits += hits;
+    }
+
+  public:
+    /// @param shardsCount number of RX queues, one shard each
+    /// @param name        unique prefix for the shards' mempool names
+    /// @param capacity    maximum number of flows tracked by all the shards together, split evenly
+    explicit ShardedFlowTable(const uint16_t shardsCount, const std::string &name = "ShardedFlowTable",
+                              const uint32_t capacity = FlowTable::DEFAULT_CAPACITY)
+        : m_Shards(shardsCount)
+    {
+        if (shardsCount == 0 || capacity < shardsCount)
+            throw std::invalid_argument("ShardedFlowTable needs at least one shard and one flow per shard");
+
+        for (uint16_t queueId = 0; queueId < shardsCount; ++queueId)
+            createShard(queueId, name, capacity / shardsCount, SOCKET_ID_ANY);
+    }
+
+    /// NUMA-aware variant, every shard is allocated on the socket of the lcore polling its queue
+    /// @param queueLcores lcore polling each RX queue, one shard per entry
+    /// @param name        unique prefix for the shards' mempool names
+    /// @param capacity    maximum number of flows tracked by all the shards together, split evenly
+    explicit ShardedFlowTable(const std::vector<unsigned> &queueLcores, const std::string &name = "ShardedFlowTable",
+                              const uint32_t capacity = FlowTable::DEFAULT_CAPACITY)
+        : m_Shards(queueLcores.size())
+    {
+        if (queueLcores.empty() || queueLcores.size() > UINT16_MAX)
+            throw std::invalid_argument("ShardedFlowTable needs between 1 and 65535 shards");
+        if (capacity < queueLcores.size())
+            throw std::invalid_argument("ShardedFlowTable needs at least one flow per shard");
+
+        const uint32_t shardCapacity = capacity / static_cast<uint32_t>(queueLcores.size());
+        for (uint16_t queueId = 0; queueId < queueLcores.size(); ++queueId)
+            createShard(queueId, name, shardCapacity, static_cast<int>(rte_lcore_to_socket_id(queueLcores[queueId])));
+    }
+
+    ~ShardedFlowTable() = default;
+
+    ShardedFlowTable(const ShardedFlowTable &) = delete;
+    ShardedFlowTable &operator=(const ShardedFlowTable &) = delete;
+
+    uint16_t shardsCount() const noexcept
+    {
+        return static_cast<uint16_t>(m_Shards.size());
+    }
+
+    /// Shard owned by the lcore polling `queueId`
+    FlowTable &shard(const uint16_t queueId) noexcept
+    {
+        return *m_Shards[queueId].mFlowTable;
+    }
+
+    /// NUMA socket the shard of `queueId` was allocated on, SOCKET_ID_ANY if it was not placed
+    int socketId(const uint16_t queueId) const noexcept
+    {
+        return m_Shards[queueId].mSocketId;
+    }
+
+    TrackDescriptor *lookup(const uint16_t queueId, const uint32_t hash, const FiveTuple &fiveTuple,
+                            FlowDirection *direction = nullptr) noexcept
+    {
+        TrackDescriptor *trackDescriptor = shard(queueId).lookup(hash, fiveTuple, direction);
+        countNodeAccess(queueId, queueId, 1, trackDescriptor != nullptr);
+        return trackDescriptor;
+    }
+
+    uint32_t lookup_bulk(const uint16_t queueId, const uint32_t *hashes, const FiveTuple *keys,
+                         TrackDescriptor **out, const uint32_t n, FlowDirection *directions = nullptr) noexcept
+    {
+        const uint32_t hits = shard(queueId).lookup_bulk(hashes, keys, out, n, directions);
+        countNodeAccess(queueId, queueId, n, hits);
+        return hits;
+    }
+
+    bool insert(const uint16_t queueId, const uint32_t hash, const FiveTuple &fiveTuple,
+                const uint16_t matchedRuleId)
+    {
+        return shard(queueId).insert(hash, fiveTuple, matchedRuleId);
+    }
+
+    template <typename Init>
+    std::pair<TrackDescriptor *, bool> find_or_insert(const uint16_t queueId, const uint32_t hash,
+                                                      const FiveTuple &fiveTuple, Init &&init,
+                                                      FlowDirection *direction = nullptr)
+    {
+        return shard(queueId).find_or_insert(hash, fiveTuple, std::forward<Init>(init), direction);
+    }
+
+    bool delete_entry(const uint16_t queueId, const uint32_t hash, TrackDescriptor *trackDescriptor)
+    {
+        return shard(queueId).delete_entry(hash, trackDescriptor);
+    }
+
+    /// Slow path for asymmetric routing, where the two directions of a flow arrive on different queues.
+    /// Looks up the local shard first and then probes every other shard read-only, see FlowTable::probe().
+    /// Foreign shards are read while their owners keep writing, so this is only safe once the shards run in
+    /// RCU mode (attach_rcu()). A descriptor found in a foreign shard belongs to its owner lcore. When
+    /// `ownerQueueId` is not `queueId`, the caller must not account, modify or delete it.
+    /// @param ownerQueueId optional, set to the queue whose shard tracks the flow
+    TrackDescriptor *lookup_any(const uint16_t queueId, const uint32_t hash, const FiveTuple &fiveTuple,
+                                uint16_t *ownerQueueId = nullptr, FlowDirection *direction = nullptr) noexcept
+    {
+        // Canonicalized once for all the shards probed
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = fiveTuple.canonical(packetDirection);
+
+        TrackDescriptor *trackDescriptor = shard(queueId).lookup(hash, canonicalFiveTuple, packetDirection, direction);
+        countNodeAccess(queueId, queueId, 1, trackDescriptor != nullptr);
+        if (trackDescriptor != nullptr)
+        {
+            if (ownerQueueId)
+                *ownerQueueId = queueId;
+            return trackDescriptor;
+        }
+
+        Shard &localShard = m_Shards[queueId];
+        ++localShard.mCrossShardLookups;
+
+        for (uint16_t otherQueueId = 0; otherQueueId < m_Shards.size(); ++otherQueueId)
+        {
+            if (otherQueueId == queueId)
+                continue;
+
+            trackDescriptor = shard(otherQueueId).probe(hash, canonicalFiveTuple, packetDirection, direction);
+            countNodeAccess(queueId, otherQueueId, 1, trackDescriptor != nullptr);
+            if (trackDescriptor != nullptr)
+            {
+                ++localShard.mCrossShardHits;
+                if (ownerQueueId)
+                    *ownerQueueId = otherQueueId;
+                return trackDescriptor;
+            }
+        }
+
+        return nullptr;
+    }
+
+    uint64_t crossShardLookups(const uint16_t queueId) const noexcept
+    {
+        return m_Shards[queueId].mCrossShardLookups;
+    }
+
+    uint64_t crossShardHits(const uint16_t queueId) const noexcept
+    {
+        return m_Shards[queueId].mCrossShardHits;
+    }
+
+    /// Lookups issued from the lcore polling `queueId` into a shard allocated on another socket
+    uint64_t crossNodeLookups(const uint16_t queueId) const noexcept
+    {
+        return m_Shards[queueId].mCrossNodeLookups;
+    }
+
+    uint64_t crossNodeHits(const uint16_t queueId) const noexcept
+    {
+        return m_Shards[queueId].mCrossNodeHits;
+    }
+};
@@ -1,13 +1,29 @@
 #pragma once
 #include "FiveTuple.hpp"
+#include "FlowCounters.hpp"
 #include "TrackDescriptor.hpp"
+#include <stdint.h>
 
-class TrackBucket
+/// Chain node of FlowTable, two cache lines: the canonical key, the link and the hot descriptor in the
+/// first one, which is all a lookup touches, and the traffic counters in the second one
+class alignas(64) TrackBucket
 {
   public:
     FiveTuple mFiveTuple;
-    TrackBucket *mPrev;
     TrackBucket *mNext;
-    TrackDescriptor *mTrackDescriptor;
-    uint8_t mRSS8LSBs;
+    uint32_t mHash;      // RSS hash, rehomes the flow when the head array grows
+    uint8_t mReferenced; // CLOCK reference bit, only maintained under EvictionPolicy::Clock
+    TrackDescriptor mTrackDescriptor;
+    FlowCounters mCounters;
+
+    /// Track bucket holding `trackDescriptor`. Track buckets are cache-line aligned mempool objects and the
+    /// descriptor lies in their first line, so masking its address is enough.
+    static TrackBucket *of(const TrackDescriptor *trackDescriptor) noexcept
+    {
+        return reinterpret_cast<TrackBucket *>(reinterpret_cast<uintptr_t>(trackDescriptor) & ~uintptr_t(63));
+    }
 };
+
+// With the counters taking the whole second line, the descriptor necessarily ends within the first one
+static_assert(sizeof(TrackBucket) == 128 && sizeof(FlowCounters) == 64,
+              "TrackBucket must keep the key and the hot descriptor in its first cache line");
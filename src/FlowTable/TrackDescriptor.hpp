@@ -1,15 +1,106 @@
 #pragma once
 
-#include <array>
+#include "Common/StaticVector/StaticVector.hpp"
+#include "FiveTuple.hpp"
+#include <new>
+#include <rte_mempool.h>
 #include <stdint.h>
 #include <tuple>
 
-class TrackBucket;
+using MatchedRule = std::tuple<uint16_t, uint16_t>;
 
+/// Cold overflow block of a tracked flow: its matched rules from the third one on. Lives in its own
+/// mempool object, only flows matching more than TrackDescriptor::INLINE_RULES_CAPACITY rules get one.
+class TrackRules
+{
+  public:
+    static constexpr uint8_t CAPACITY = 14; // one cache line with the size field
+
+    StaticVector<MatchedRule, CAPACITY> mMatchedRules;
+};
+
+/// Hot side of a tracked flow, stored inline next to the flow key: everything the per-packet path reads
+/// or writes, so a hit touches a single cache line. The first matched rules live inline, the first one
+/// being the verdict of the flow.
 class TrackDescriptor
 {
   public:
-    TrackBucket *mParentTrackBucket;
+    static constexpr uint8_t INLINE_RULES_CAPACITY = 2;
+    static constexpr uint8_t RULES_CAPACITY = INLINE_RULES_CAPACITY + TrackRules::CAPACITY;
+    static constexpr uint8_t FLAG_REVERSE_ORIGIN = 0x80; // the first packet traveled against the canonical key
+
     uint64_t mLastSeen;
-    std::array<std::tuple<uint16_t, uint16_t>, 16> mMatchedRules;
+    uint32_t mPackets; // maintained by the caller
+    uint8_t mFlags;    // caller-defined, except FLAG_REVERSE_ORIGIN set by the flow table on insert
+    uint8_t mRulesCount;
+    MatchedRule mInlineRules[INLINE_RULES_CAPACITY];
+    TrackRules *mRules; // overflow block, nullptr until more than INLINE_RULES_CAPACITY rules match
+
+    /// mFlags of a flow whose first packet traveled in `packetDirection` relative to the canonical key
+    static constexpr uint8_t origin_flags(const FlowDirection packetDirection) noexcept
+    {
+        return packetDirection == FlowDirection::Reverse ? FLAG_REVERSE_ORIGIN : 0;
+    }
+
+    /// Direction of a packet relative to the first packet of the flow, Forward for the initiator
+    /// @param packetDirection direction of the packet relative to the canonical key
+    FlowDirection direction(const FlowDirection packetDirection) const noexcept
+    {
+        const uint8_t reversedOrigin = (mFlags & FLAG_REVERSE_ORIGIN) != 0;
+        return static_cast<FlowDirection>(static_cast<uint8_t>(packetDirection) ^ reversedOrigin);
+    }
+
+    uint8_t rules_count() const noexcept
+    {
+        return __atomic_load_n(&mRulesCount, __ATOMIC_ACQUIRE);
+    }
+
+    /// @param index below rules_count()
+    const MatchedRule &rule(const uint8_t index) const noexcept
+    {
+        return index < INLINE_RULES_CAPACITY ? mInlineRules[index]
+                                             : mRules->mMatchedRules[index - INLINE_RULES_CAPACITY];
+    }
+
+    /// Appends a matched rule, spilling to an overflow block from `overflowPool` past the inline ones.
+    /// The rule is published with a release store of the count, so lock-free readers see it whole.
+    /// @param overflowPool pool of TrackRules, nullptr limits the flow to the inline rules
+    /// @return false when the flow has no room left or the pool is exhausted
+    bool add_rule(const MatchedRule &matchedRule, rte_mempool *overflowPool) noexcept
+    {
+        if (mRulesCount < INLINE_RULES_CAPACITY)
+        {
+            mInlineRules[mRulesCount] = matchedRule;
+        }
+        else
+        {
+            if (mRules == nullptr)
+            {
+                TrackRules *trackRules = nullptr;
+                if (overflowPool == nullptr || rte_mempool_get(overflowPool, (void **)&trackRules) != 0)
+                    return false;
+                new (trackRules) TrackRules();
+                mRules = trackRules;
+            }
+            if (mRules->mMatchedRules.size() == TrackRules::CAPACITY)
+                return false;
+            mRules->mMatchedRules.push_back(matchedRule);
+        }
+
+        __atomic_store_n(&mRulesCount, mRulesCount + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /// Gives the overflow block back to its pool
+    void release_rules(rte_mempool *overflowPool) noexcept
+    {
+        if (mRules == nullptr)
+            return;
+
+        mRules->~TrackRules();
+        rte_mempool_put(overflowPool, mRules);
+        mRules = nullptr;
+    }
 };
+
+static_assert(sizeof(TrackDescriptor) == 32, "TrackDescriptor must leave room for the key in one cache line");
@@ -2,21 +2,144 @@
 
 #include "AgingHashMap.hpp"
 #include "FlowTable/FiveTuple.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <tuple>
 
 class NewTrackDescriptor
 {
   public:
-    NewTrackDescriptor() = default;
+    static constexpr uint8_t FLAG_REVERSE_ORIGIN = 0x80; // the first packet traveled against the canonical key
+
+    /// @param packetDirection direction of the first packet of the flow relative to the canonical key
+    NewTrackDescriptor(const FiveTuple &canonicalFiveTuple, const FlowDirection packetDirection,
+                       const uint16_t matchedRuleId)
+        : mFiveTuple(canonicalFiveTuple)
+        , mFlags(packetDirection == FlowDirection::Reverse ? FLAG_REVERSE_ORIGIN : 0)
+        , mMatchedRules{std::make_tuple(matchedRuleId, static_cast<uint16_t>(100))}
+    {
+    }
     ~NewTrackDescriptor() = default;
+
+    /// Direction of a packet relative to the first packet of the flow, Forward for the initiator
+    /// @param packetDirection direction of the packet relative to the canonical key
+    FlowDirection direction(const FlowDirection packetDirection) const noexcept
+    {
+        const uint8_t reversedOrigin = (mFlags & FLAG_REVERSE_ORIGIN) != 0;
+        return static_cast<FlowDirection>(static_cast<uint8_t>(packetDirection) ^ reversedOrigin);
+    }
+
+    FiveTuple mFiveTuple; // canonical key, lets delete_entry() erase from a descriptor
+    // No mLastSeen, AgingHashMap tracks the idle time of the entry
+    uint8_t mFlags; // caller-defined, except FLAG_REVERSE_ORIGIN set on insert
+    std::array<std::tuple<uint16_t, uint16_t>, 16> mMatchedRules;
 };
 
+/// Flow tracker with the FlowTable API on top of AgingHashMap. Flows are keyed by their canonical five
+/// tuple, so both directions resolve to the same descriptor, and every access goes through the
+/// *_with_hash methods with the NIC RSS hash, which must therefore be symmetric. Idle flows expire after
+/// the TTL from manageTimers(). Like FlowTable, a table is owned by a single lcore.
+/// Directions are reported relative to the first packet of the flow, as FlowTable does.
+/// @tparam Capacity flows the table holds, its pools are sized for it up front
+template <std::size_t Capacity = (1 << 22) - 1>
 class NewFlowTable
 {
   private:
-    static constexpr int MAX_TRACKED_SESSIONS = (1 << 22) - 1;
-    AgingHashMap<FiveTuple, NewTrackDescriptor, MAX_TRACKED_SESSIONS> m_Hashmap;
+    static constexpr uint32_t BULK_GROUP_SIZE = RTE_HASH_LOOKUP_BULK_MAX;
+
+    // Single writer, so the rte_hash reader/writer lock is left out
+    using FlowHashMap = AgingHashMap<FiveTuple, NewTrackDescriptor, Capacity, void, RTE_MEMPOOL_CACHE_MAX_SIZE,
+                                     RTE_HASH_EXTRA_FLAGS_EXT_TABLE>;
+
+    FlowHashMap m_Hashmap;
 
   public:
-    NewFlowTable();
+    /// @param name    unique prefix for the mempool and hash names
+    /// @param ttl_sec idle time after which a flow expires
+    explicit NewFlowTable(const std::string &name = "NewFlowTable", const uint64_t ttl_sec = 30)
+        : m_Hashmap(name, ttl_sec)
+    {
+    }
+
     ~NewFlowTable() = default;
-};
\ No newline at end of file
+
+    NewFlowTable(const NewFlowTable &) = delete;
+    NewFlowTable &operator=(const NewFlowTable &) = delete;
+
+    /// Refreshes the TTL of the flow on a hit
+    /// @param direction optional, set to the direction of the packet relative to the first packet of the
+    ///                  flow, Forward on a miss
+    NewTrackDescriptor *lookup(const uint32_t hash, const FiveTuple &fiveTuple,
+                               FlowDirection *direction = nullptr) noexcept
+    {
+        FlowDirection packetDirection;
+        const FiveTuple canonicalFiveTuple = fiveTuple.canonical(packetDirection);
+
+        NewTrackDescriptor *trackDescriptor = m_Hashmap.template lookup_with_hash<true>(canonicalFiveTuple, hash);
+        if (direction)
+            *direction = trackDescriptor ? trackDescriptor->direction(packetDirection) : FlowDirection::Forward;
+        return trackDescriptor;
+    }
+
+    /// Burst variant of lookup(), resolved RTE_HASH_LOOKUP_BULK_MAX keys at a time
+    /// @return number of hits
+    uint32_t lookup_bulk(const uint32_t *hashes, const FiveTuple *keys, NewTrackDescriptor **out, const uint32_t n,
+                         FlowDirection *directions = nullptr) noexcept
+    {
+        FiveTuple canonicalKeys[BULK_GROUP_SIZE];
+        FlowDirection packetDirections[BULK_GROUP_SIZE];
+        uint32_t hits = 0;
+
+        for (uint32_t base = 0; base < n; base += BULK_GROUP_SIZE)
+        {
+            const uint32_t count = (n - base < BULK_GROUP_SIZE) ? (n - base) : BULK_GROUP_SIZE;
+
+            for (uint32_t i = 0; i < count; ++i)
+                canonicalKeys[i] = keys[base + i].canonical(packetDirections[i]);
+
+            const int groupHits =
+                m_Hashmap.template lookup_bulk_with_hash<true>(canonicalKeys, hashes + base, count, out + base);
+            if (groupHits > 0)
+                hits += static_cast<uint32_t>(groupHits);
+
+            if (directions)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                    directions[base + i] =
+                        out[base + i] ? out[base + i]->direction(packetDirections[i]) : FlowDirection::Forward;
+            }
+        }
+
+        return hits;
+    }
+
+    bool delete_entry(const uint32_t hash, NewTrackDescriptor *trackDescriptor)
+    {
+        if (trackDescriptor == nullptr)
+            return false;
+
+        // Copy the key, erasing destroys the descriptor
+        const FiveTuple canonicalFiveTuple = trackDescriptor->mFiveTuple;
+        return m_Hashmap.erase_with_hash(canonicalFiveTuple, hash);
+    }
+
+    /// Inserts the flow, or refreshes the TTL of an already tracked one
+    bool insert(const uint32_t hash, const FiveTuple &packetFiveTuple, const uint16_t matchedRuleId)
+    {
+        FlowDirection packetDirection;
+        const FiveTuple fiveTuple = packetFiveTuple.canonical(packetDirection);
+        return m_Hashmap.try_emplace_with_hash(fiveTuple, hash, fiveTuple, packetDirection, matchedRuleId) != nullptr;
+    }
+
+    /// Expires the flows idle for longer than the TTL, call it periodically from the owning lcore
+    void manageTimers()
+    {
+        m_Hashmap.manageTimers();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_Hashmap.size();
+    }
+};
@@ -0,0 +1,330 @@
+#include "AgingHashMap.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+class FlowKey
+{
+  public:
+    uint32_t mAddress;
+    uint32_t mPort;
+};
+
+/// A key laid out like the Toeplitz hash input: 16-bit aligned fields the reverse direction swaps
+class TupleKey
+{
+  public:
+    uint32_t mSrcAddress;
+    uint32_t mDstAddress;
+    uint16_t mSrcPort;
+    uint16_t mDstPort;
+
+    TupleKey reverse() const noexcept
+    {
+        return TupleKey{mDstAddress, mSrcAddress, mDstPort, mSrcPort};
+    }
+};
+
+/// Keeps each entry the first time it expires
+class KeepOnce
+{
+  public:
+    uint32_t *mCalls;
+
+    bool operator()(const FlowKey &, const uint32_t &) const noexcept
+    {
+        return ++*mCalls > 1;
+    }
+};
+
+/// Counts the expired entries and lets them go
+class CountExpired
+{
+  public:
+    uint32_t *mCalls;
+
+    bool operator()(const FlowKey &, const uint32_t &) const noexcept
+    {
+        ++*mCalls;
+        return true;
+    }
+};
+
+using WheelMap = AgingHashMap<FlowKey, uint32_t, 1023, CountExpired, 0, RTE_HASH_EXTRA_FLAGS_EXT_TABLE>;
+using SmallMap = AgingHashMap<FlowKey, uint32_t, 7, void, 0, RTE_HASH_EXTRA_FLAGS_EXT_TABLE>;
+template <typename HashPolicy>
+using PolicyMap =
+    AgingHashMap<TupleKey, uint32_t, 1023, void, 0, RTE_HASH_EXTRA_FLAGS_EXT_TABLE, AgingMode::TimerWheel, HashPolicy>;
+using LazyMap = AgingHashMap<FlowKey, uint32_t, 1023, void, 0, RTE_HASH_EXTRA_FLAGS_EXT_TABLE, AgingMode::LazyRteTimer>;
+using LazyKeepOnceMap =
+    AgingHashMap<FlowKey, uint32_t, 1023, KeepOnce, 0, RTE_HASH_EXTRA_FLAGS_EXT_TABLE, AgingMode::LazyRteTimer>;
+
+/// Timer wheel granularity, in rte_get_timer_hz() ticks
+const uint64_t WHEEL_TICK = rte_get_timer_hz() / 100;
+
+/// 100 ms: short enough for the test, long enough for the timer wheel granularity
+const uint64_t TTL_TICKS = rte_get_timer_hz() / 10;
+
+/// Spins until the timer reaches `deadline`
+uint64_t waitUntil(const uint64_t deadline)
+{
+    uint64_t now;
+    while ((now = rte_get_timer_cycles()) < deadline)
+        rte_pause();
+    return now;
+}
+
+/// Inserts, finds and erases a batch of keys through a map hashing them with HashPolicy
+template <typename HashPolicy>
+void roundTrip(const std::string &name)
+{
+    PolicyMap<HashPolicy> map(name);
+    for (uint32_t i = 0; i < 100; ++i)
+        ASSERT_NE(map.try_emplace(TupleKey{0x0a000000 + i, 0xc0a80001, uint16_t(1024 + i), 443}, i), nullptr);
+    ASSERT_EQ(map.size(), 100u);
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        const uint32_t *value = map.lookup(TupleKey{0x0a000000 + i, 0xc0a80001, uint16_t(1024 + i), 443});
+        ASSERT_NE(value, nullptr);
+        ASSERT_EQ(*value, i);
+    }
+
+    for (uint32_t i = 0; i < 100; ++i)
+        ASSERT_TRUE(map.erase(TupleKey{0x0a000000 + i, 0xc0a80001, uint16_t(1024 + i), 443}));
+    ASSERT_EQ(map.size(), 0u);
+}
+} // namespace
+
+TEST(AgingHashMapTests, LazyTouchRearmsForTheRemainingTime)
+{
+    LazyMap map("AgingHashMapTests_touch");
+    map.set_ttl_ticks(TTL_TICKS);
+    const FlowKey key{0x0a000001, 80};
+    const uint64_t start = rte_get_timer_cycles();
+    ASSERT_NE(map.try_emplace(key, 1u), nullptr);
+    const uint64_t inserted = rte_get_timer_cycles();
+
+    // Touched at 1/2 TTL or later: the timer fires after 1 TTL, finds the touch and re-arms
+    waitUntil(start + TTL_TICKS / 2);
+    map.manageTimers();
+    ASSERT_NE(map.lookup<true>(key), nullptr);
+    const uint64_t touched = rte_get_timer_cycles();
+
+    waitUntil(inserted + TTL_TICKS + 1);
+    map.manageTimers();
+    if (rte_get_timer_cycles() >= start + TTL_TICKS / 2 + TTL_TICKS)
+        GTEST_SKIP() << "descheduled past the touched deadline";
+    ASSERT_NE(map.lookup(key), nullptr);
+
+    waitUntil(touched + TTL_TICKS + 1);
+    map.manageTimers();
+    ASSERT_EQ(map.lookup(key), nullptr);
+    ASSERT_EQ(map.size(), 0u);
+}
+
+TEST(AgingHashMapTests, LazyKeptByExpireFnExpiresAgain)
+{
+    uint32_t calls = 0;
+    LazyKeepOnceMap map("AgingHashMapTests_keep", KeepOnce{&calls});
+    map.set_ttl_ticks(TTL_TICKS);
+    const FlowKey key{0x0a000002, 443};
+    ASSERT_NE(map.try_emplace(key, 2u), nullptr);
+
+    waitUntil(rte_get_timer_cycles() + TTL_TICKS + 1);
+    map.manageTimers();
+    const uint64_t kept = rte_get_timer_cycles();
+    ASSERT_EQ(calls, 1u);
+    ASSERT_NE(map.lookup(key), nullptr);
+
+    // The kept entry is re-armed for another TTL, without any touch
+    waitUntil(kept + TTL_TICKS + 1);
+    map.manageTimers();
+    ASSERT_EQ(calls, 2u);
+    ASSERT_EQ(map.lookup(key), nullptr);
+}
+
+TEST(AgingHashMapTests, WheelExpiresRefreshesAndCancels)
+{
+    uint32_t calls = 0;
+    WheelMap map("AgingHashMapTests_wheel", CountExpired{&calls});
+    map.set_ttl_ticks(TTL_TICKS);
+    const FlowKey touchedKey{0x0a000003, 53};
+    const FlowKey idleKey{0x0a000004, 53};
+    const FlowKey erasedKey{0x0a000005, 53};
+    map.manageTimers();
+    const uint64_t start = rte_get_timer_cycles();
+    ASSERT_NE(map.try_emplace(touchedKey, 3u), nullptr);
+    ASSERT_NE(map.try_emplace(idleKey, 4u), nullptr);
+    ASSERT_NE(map.try_emplace(erasedKey, 5u), nullptr);
+
+    // The erased entry leaves the wheel, it must never reach the expire function
+    ASSERT_TRUE(map.erase(erasedKey));
+    ASSERT_EQ(map.size(), 2u);
+
+    waitUntil(start + TTL_TICKS / 2);
+    map.manageTimers();
+    ASSERT_NE(map.lookup<true>(touchedKey), nullptr);
+    const uint64_t touched = rte_get_timer_cycles();
+
+    waitUntil(start + TTL_TICKS + 2 * WHEEL_TICK);
+    map.manageTimers();
+    if (rte_get_timer_cycles() >= start + TTL_TICKS / 2 + TTL_TICKS - WHEEL_TICK)
+        GTEST_SKIP() << "descheduled past the touched deadline";
+    ASSERT_EQ(calls, 1u);
+    ASSERT_EQ(map.lookup(idleKey), nullptr);
+    ASSERT_NE(map.lookup(touchedKey), nullptr);
+
+    waitUntil(touched + TTL_TICKS + 2 * WHEEL_TICK);
+    map.manageTimers();
+    ASSERT_EQ(calls, 2u);
+    ASSERT_EQ(map.lookup(touchedKey), nullptr);
+    ASSERT_EQ(map.size(), 0u);
+}
+
+TEST(AgingHashMapTests, BulkOperations)
+{
+    SmallMap map("AgingHashMapTests_bulk");
+    for (uint32_t i = 0; i < 4; ++i)
+        ASSERT_NE(map.try_emplace(FlowKey{i, i}, i), nullptr);
+
+    // Partial hits
+    const FlowKey lookupKeys[] = {{0, 0}, {1, 1}, {8, 8}, {2, 2}, {9, 9}};
+    uint32_t *values[5];
+    uint64_t hitMask = 0;
+    ASSERT_EQ(map.lookup_bulk(lookupKeys, 5, values, &hitMask), 3);
+    ASSERT_EQ(hitMask, 0b01011u);
+    ASSERT_EQ(*values[0], 0u);
+    ASSERT_EQ(*values[1], 1u);
+    ASSERT_EQ(values[2], nullptr);
+    ASSERT_EQ(*values[3], 2u);
+    ASSERT_EQ(values[4], nullptr);
+
+    // 3 free slots left: {10, 10} is inserted once for both occurrences, {13, 13} and {14, 14} do not fit
+    const FlowKey emplaceKeys[] = {{0, 0}, {10, 10}, {10, 10}, {11, 11}, {12, 12}, {13, 13}, {14, 14}};
+    const uint32_t emplaceValues[] = {100, 10, 20, 11, 12, 13, 14};
+    uint32_t *out[7];
+    uint64_t failedMask = 0;
+    ASSERT_EQ(map.try_emplace_bulk(emplaceKeys, emplaceValues, 7, out, &failedMask), 5);
+    ASSERT_EQ(failedMask, 0b1100000u);
+    ASSERT_EQ(*out[0], 0u); // existing values are kept
+    ASSERT_EQ(out[1], out[2]);
+    ASSERT_EQ(*out[1], 10u);
+    ASSERT_EQ(*out[4], 12u);
+    ASSERT_EQ(out[5], nullptr);
+    ASSERT_EQ(out[6], nullptr);
+    ASSERT_EQ(map.size(), 7u);
+
+    // A key repeated in the burst is erased once
+    const FlowKey eraseKeys[] = {{0, 0}, {0, 0}, {10, 10}, {99, 99}};
+    ASSERT_EQ(map.erase_bulk(eraseKeys, 4), 2);
+    ASSERT_EQ(map.size(), 5u);
+    ASSERT_EQ(map.lookup(FlowKey{0, 0}), nullptr);
+    ASSERT_EQ(map.lookup(FlowKey{10, 10}), nullptr);
+}
+
+TEST(AgingHashMapTests, BulkRejectsOversizedBursts)
+{
+    SmallMap map("AgingHashMapTests_oversized");
+    FlowKey keys[RTE_HASH_LOOKUP_BULK_MAX + 1] = {};
+    uint32_t valuesIn[RTE_HASH_LOOKUP_BULK_MAX + 1] = {};
+    uint32_t *values[RTE_HASH_LOOKUP_BULK_MAX + 1];
+
+    ASSERT_EQ(map.lookup_bulk(keys, RTE_HASH_LOOKUP_BULK_MAX + 1, values), -EINVAL);
+    ASSERT_EQ(map.try_emplace_bulk(keys, valuesIn, RTE_HASH_LOOKUP_BULK_MAX + 1, values), -EINVAL);
+    ASSERT_EQ(map.erase_bulk(keys, RTE_HASH_LOOKUP_BULK_MAX + 1), -EINVAL);
+    ASSERT_EQ(map.lookup_bulk(keys, 0, values), -EINVAL);
+    ASSERT_EQ(map.size(), 0u);
+}
+
+TEST(AgingHashMapTests, PrecomputedHash)
+{
+    PolicyMap<JHashPolicy> map("AgingHashMapTests_hash");
+    const TupleKey keys[] = {{0x0a000001, 0xc0a80001, 1024, 80}, {0x0a000002, 0xc0a80001, 1025, 80}};
+    // e.g. the NIC RSS value, unrelated to what JHashPolicy computes
+    const hash_sig_t hashes[] = {0x5eed0001, 0x5eed0002};
+
+    ASSERT_NE(map.try_emplace_with_hash(keys[0], hashes[0], 1u), nullptr);
+    ASSERT_NE(map.try_emplace_with_hash(keys[1], hashes[1], 2u), nullptr);
+    ASSERT_EQ(*map.lookup_with_hash(keys[0], hashes[0]), 1u);
+    ASSERT_EQ(*map.lookup_with_hash<true>(keys[1], hashes[1]), 2u);
+
+    uint32_t *values[2];
+    uint64_t hitMask = 0;
+    ASSERT_EQ(map.lookup_bulk_with_hash(keys, hashes, 2, values, &hitMask), 2);
+    ASSERT_EQ(hitMask, 0b11u);
+    ASSERT_EQ(*values[1], 2u);
+
+    ASSERT_TRUE(map.erase_with_hash(keys[0], hashes[0]));
+    ASSERT_FALSE(map.erase_with_hash(keys[0], hashes[0]));
+    ASSERT_EQ(map.lookup_with_hash(keys[0], hashes[0]), nullptr);
+    ASSERT_EQ(map.size(), 1u);
+}
+
+TEST(AgingHashMapTests, Crc32cPolicyRoundTrip)
+{
+    roundTrip<Crc32cHashPolicy>("AgingHashMapTests_crc");
+}
+
+TEST(AgingHashMapTests, SymmetricToeplitzPolicyRoundTrip)
+{
+    roundTrip<SymmetricToeplitzHashPolicy>("AgingHashMapTests_toeplitz");
+}
+
+TEST(AgingHashMapTests, SymmetricToeplitzMatchesTheReverseTuple)
+{
+    const TupleKey tuple{0x0a000001, 0xc0a80101, 51234, 443};
+    const uint32_t hash = SymmetricToeplitzHashPolicy::hash(&tuple, sizeof(tuple), 0);
+    const TupleKey reverse = tuple.reverse();
+
+    ASSERT_EQ(SymmetricToeplitzHashPolicy::hash(&reverse, sizeof(reverse), 0), hash);
+    const TupleKey other{0x0a000001, 0xc0a80101, 51235, 443};
+    ASSERT_NE(SymmetricToeplitzHashPolicy::hash(&other, sizeof(other), 0), hash);
+}
+
+TEST(AgingHashMapTests, SampledLruEviction)
+{
+    uint32_t calls = 0;
+    WheelMap map("AgingHashMapTests_evict", CountExpired{&calls});
+    const FlowKey keys[] = {{0x0a000006, 22}, {0x0a000007, 22}, {0x0a000008, 22}, {0x0a000009, 22}};
+
+    // The sample covers every entry, so the one with the earliest deadline is evicted
+    map.set_eviction(EvictionPolicy::SampledLru, 3, 16);
+    ASSERT_NE(map.try_emplace(keys[0], 0u), nullptr);
+    waitUntil(rte_get_timer_cycles() + 2 * WHEEL_TICK);
+    map.manageTimers();
+    ASSERT_NE(map.try_emplace(keys[1], 1u), nullptr);
+    ASSERT_NE(map.try_emplace(keys[2], 2u), nullptr);
+    ASSERT_NE(map.try_emplace(keys[3], 3u), nullptr);
+
+    ASSERT_EQ(map.size(), 3u);
+    ASSERT_EQ(map.evictionStats().mEvictions, 1u);
+    ASSERT_EQ(calls, 1u); // evictions notify the expire function
+    ASSERT_EQ(map.lookup(keys[0]), nullptr);
+    ASSERT_NE(map.lookup(keys[3]), nullptr);
+}
+
+TEST(AgingHashMapTests, RejectsBucketEvictionPolicies)
+{
+    LazyMap map("AgingHashMapTests_policies");
+    ASSERT_THROW(map.set_eviction(EvictionPolicy::Clock), std::invalid_argument);
+    ASSERT_THROW(map.set_eviction(EvictionPolicy::OldestInBucket), std::invalid_argument);
+    ASSERT_NO_THROW(map.set_eviction(EvictionPolicy::SampledLru));
+    ASSERT_NO_THROW(map.set_eviction(EvictionPolicy::None));
+}
+
+TEST(AgingHashMapTests, EvictsAndRetriesWhenThePoolIsEmpty)
+{
+    SmallMap map("AgingHashMapTests_retry");
+    for (uint32_t i = 0; i < 7; ++i)
+        ASSERT_NE(map.try_emplace(FlowKey{i, i}, i), nullptr);
+    ASSERT_EQ(map.try_emplace(FlowKey{7, 7}, 7u), nullptr);
+    ASSERT_EQ(map.evictionStats().mInsertFailures, 1u);
+
+    // The watermark is above the pool size, only the empty pool triggers an eviction
+    map.set_eviction(EvictionPolicy::SampledLru, 8, 16);
+    ASSERT_NE(map.try_emplace(FlowKey{7, 7}, 7u), nullptr);
+    ASSERT_EQ(map.size(), 7u);
+    ASSERT_EQ(map.evictionStats().mEvictions, 1u);
+    ASSERT_EQ(map.evictionStats().mInsertFailures, 1u);
+}
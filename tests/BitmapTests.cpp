@@ -0,0 +1,259 @@
+#include "Common/Bitmap/AggregatedBitmap.hpp"
+#include "Common/Bitmap/Bitmap.hpp"
+#include "Common/Bitmap/BitsetPool.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+static constexpr size_t RULES_COUNT = 65536;
+static constexpr size_t FIELDS_COUNT = 10;
+
+using RulesBitmap = Bitmap<RULES_COUNT, FIELDS_COUNT>;
+using RulesBitset = Bitset<RULES_COUNT>;
+
+static std::unique_ptr<RulesBitmap> makeBitmap(const uint32_t seed)
+{
+    auto bitmap = std::make_unique<RulesBitmap>();
+    std::mt19937_64 generator(seed);
+    for (auto &bitset : bitmap->getData())
+    {
+        // Dense rows, so a good share of the result bits survive all the fields
+        for (size_t i = 0; i < RulesBitset::WORDS_COUNT; ++i)
+            bitset.data()[i] = generator() | generator() | generator();
+    }
+    return bitmap;
+}
+
+static RulesBitset referenceAND(const RulesBitmap &bitmap)
+{
+    RulesBitset result;
+    result.set();
+    for (const auto &bitset : bitmap.getData())
+        result &= bitset;
+    return result;
+}
+
+TEST(BitsetTests, SetResetTestCount)
+{
+    auto bitset = std::make_unique<RulesBitset>();
+    ASSERT_TRUE(bitset->none());
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(bitset->data()) % 64, 0u);
+
+    bitset->set(0).set(63).set(64).set(RULES_COUNT - 1);
+    ASSERT_EQ(bitset->count(), 4u);
+    ASSERT_TRUE(bitset->test(63));
+    ASSERT_TRUE(bitset->test(64));
+    ASSERT_FALSE(bitset->test(65));
+
+    bitset->reset(63);
+    ASSERT_FALSE(bitset->test(63));
+    ASSERT_EQ(bitset->count(), 3u);
+
+    bitset->set();
+    ASSERT_EQ(bitset->count(), RULES_COUNT);
+    bitset->reset();
+    ASSERT_TRUE(bitset->none());
+}
+
+TEST(BitmapTests, OperateANDMatchesReferenceForEveryKernel)
+{
+    const auto bitmap = makeBitmap(1);
+    const RulesBitset expected = referenceAND(*bitmap);
+    ASSERT_TRUE(expected.any());
+
+    for (const auto kernel : {BitsetKernels::Kernel::Scalar, BitsetKernels::Kernel::Sse2,
+                              BitsetKernels::Kernel::Avx2, BitsetKernels::Kernel::Avx512})
+    {
+        if (!BitsetKernels::supported(kernel))
+            continue;
+        ASSERT_TRUE(bitmap->OperateAND(kernel) == expected) << BitsetKernels::name(kernel);
+    }
+
+    ASSERT_TRUE(bitmap->OperateAND() == expected);
+}
+
+TEST(BitmapTests, KernelsHandleTailWords)
+{
+    // 11 words: one full 8-word block and a scalar tail, rows padded to keep them 64-byte aligned
+    alignas(64) uint64_t rows[3][16];
+    alignas(64) uint64_t result[11];
+    std::mt19937_64 generator(2);
+    for (auto &row : rows)
+        for (auto &word : row)
+            word = generator() | generator();
+    const uint64_t *rowPointers[] = {rows[0], rows[1], rows[2]};
+
+    for (const auto kernel : {BitsetKernels::Kernel::Scalar, BitsetKernels::Kernel::Sse2,
+                              BitsetKernels::Kernel::Avx2, BitsetKernels::Kernel::Avx512})
+    {
+        if (!BitsetKernels::supported(kernel))
+            continue;
+
+        BitsetKernels::andFunction(kernel)(result, rowPointers, 3, 11);
+        for (size_t i = 0; i < 11; ++i)
+            ASSERT_EQ(result[i], rows[0][i] & rows[1][i] & rows[2][i]) << BitsetKernels::name(kernel) << " " << i;
+
+        // No rows is the identity of AND
+        BitsetKernels::andFunction(kernel)(result, rowPointers, 0, 11);
+        for (size_t i = 0; i < 11; ++i)
+            ASSERT_EQ(result[i], ~0ULL);
+    }
+}
+
+TEST(BitmapTests, FusedFirstAndTopKMatchReference)
+{
+    for (const uint32_t seed : {3, 4, 5})
+    {
+        const auto bitmap = makeBitmap(seed);
+        const RulesBitset expected = referenceAND(*bitmap);
+
+        std::vector<uint32_t> expectedIds;
+        for (size_t i = 0; i < RULES_COUNT && expectedIds.size() < RulesBitmap::TOP_K_MAX; ++i)
+        {
+            if (expected.test(i))
+                expectedIds.push_back(static_cast<uint32_t>(i));
+        }
+        ASSERT_EQ(expectedIds.size(), RulesBitmap::TOP_K_MAX);
+
+        for (const auto kernel : {BitsetKernels::Kernel::Scalar, BitsetKernels::Kernel::Sse2,
+                                  BitsetKernels::Kernel::Avx2, BitsetKernels::Kernel::Avx512})
+        {
+            if (!BitsetKernels::supported(kernel))
+                continue;
+
+            ASSERT_EQ(bitmap->OperateANDFirst(kernel), expectedIds[0]) << BitsetKernels::name(kernel);
+
+            uint32_t ids[RulesBitmap::TOP_K_MAX];
+            ASSERT_EQ(bitmap->OperateANDTopK(ids, RulesBitmap::TOP_K_MAX, kernel), RulesBitmap::TOP_K_MAX);
+            ASSERT_TRUE(std::equal(expectedIds.begin(), expectedIds.end(), ids)) << BitsetKernels::name(kernel);
+        }
+    }
+}
+
+TEST(BitmapTests, FusedMatchOnSparseRows)
+{
+    auto bitmap = std::make_unique<RulesBitmap>();
+    for (auto &bitset : bitmap->getData())
+        bitset.set(7).set(40000).set(65535);
+    bitmap->getData()[3].reset(7); // rule 7 fails one field
+
+    for (const auto kernel : {BitsetKernels::Kernel::Scalar, BitsetKernels::Kernel::Sse2,
+                              BitsetKernels::Kernel::Avx2, BitsetKernels::Kernel::Avx512})
+    {
+        if (!BitsetKernels::supported(kernel))
+            continue;
+
+        ASSERT_EQ(bitmap->OperateANDFirst(kernel), 40000u) << BitsetKernels::name(kernel);
+
+        uint32_t ids[RulesBitmap::TOP_K_MAX];
+        ASSERT_EQ(bitmap->OperateANDTopK(ids, RulesBitmap::TOP_K_MAX, kernel), 2u);
+        ASSERT_EQ(ids[0], 40000u);
+        ASSERT_EQ(ids[1], 65535u);
+    }
+
+    bitmap->getData()[0].reset();
+    ASSERT_EQ(bitmap->OperateANDFirst(), RulesBitmap::NO_MATCH);
+}
+
+TEST(AggregatedBitsetTests, SummaryFollowsUpdates)
+{
+    auto bitset = std::make_unique<AggregatedBitset<RULES_COUNT>>();
+    ASSERT_TRUE(bitset->none());
+
+    bitset->set(5).set(600);
+    ASSERT_TRUE(bitset->blockAny(0));
+    ASSERT_TRUE(bitset->blockAny(1));
+    ASSERT_FALSE(bitset->blockAny(2));
+
+    bitset->reset(600);
+    ASSERT_FALSE(bitset->blockAny(1));
+    ASSERT_EQ(bitset->count(), 1u);
+
+    bitset->data()[RulesBitset::WORDS_COUNT - 1] = 1;
+    ASSERT_FALSE(bitset->blockAny(AggregatedBitset<RULES_COUNT>::BLOCKS_COUNT - 1));
+    bitset->rebuildSummary();
+    ASSERT_TRUE(bitset->blockAny(AggregatedBitset<RULES_COUNT>::BLOCKS_COUNT - 1));
+}
+
+TEST(AggregatedBitmapTests, MatchesFlatBitmapOnSparseRows)
+{
+    auto bitmap = std::make_unique<RulesBitmap>();
+    auto aggregatedBitmap = std::make_unique<AggregatedBitmap<RULES_COUNT, FIELDS_COUNT>>();
+
+    // Every field matches a few rule ranges, and all of them share the rules of a handful of blocks
+    std::mt19937 generator(6);
+    for (size_t field = 0; field < FIELDS_COUNT; ++field)
+    {
+        auto &bitset = bitmap->getData()[field];
+        for (int range = 0; range < 8; ++range)
+        {
+            const size_t first = generator() % RULES_COUNT;
+            for (size_t rule = first; rule < first + 300 && rule < RULES_COUNT; ++rule)
+                bitset.set(rule);
+        }
+        for (const size_t rule : {1000, 1001, 30000, 65000})
+            bitset.set(rule);
+        aggregatedBitmap->getData()[field] = AggregatedBitset<RULES_COUNT>(bitset);
+    }
+
+    const RulesBitset expected = bitmap->OperateAND();
+    ASSERT_TRUE(aggregatedBitmap->OperateAND().bits() == expected);
+    ASSERT_EQ(aggregatedBitmap->OperateANDFirst(), bitmap->OperateANDFirst());
+
+    uint32_t expectedIds[RulesBitmap::TOP_K_MAX];
+    uint32_t ids[RulesBitmap::TOP_K_MAX];
+    const size_t expectedCount = bitmap->OperateANDTopK(expectedIds, RulesBitmap::TOP_K_MAX);
+    ASSERT_GE(expectedCount, 4u);
+    ASSERT_EQ(aggregatedBitmap->OperateANDTopK(ids, RulesBitmap::TOP_K_MAX), expectedCount);
+    ASSERT_TRUE(std::equal(expectedIds, expectedIds + expectedCount, ids));
+
+    aggregatedBitmap->getData()[2].reset();
+    ASSERT_TRUE(aggregatedBitmap->OperateAND().none());
+    ASSERT_EQ(aggregatedBitmap->OperateANDFirst(), RulesBitmap::NO_MATCH);
+}
+
+TEST(BitsetPoolTests, EqualBitsetsShareOneRefcountedCopy)
+{
+    BitsetPool<AggregatedBitset<RULES_COUNT>> pool;
+    auto bits = std::make_unique<AggregatedBitset<RULES_COUNT>>();
+    bits->set(1).set(40000);
+
+    const auto *first = pool.acquire(*bits);
+    const auto *second = pool.acquire(*bits);
+    ASSERT_EQ(first, second);
+    ASSERT_NE(first, bits.get());
+
+    bits->set(2);
+    const auto *other = pool.acquire(*bits);
+    ASSERT_NE(other, first);
+    ASSERT_TRUE(*other == *bits);
+
+    BitsetPoolReport report = pool.report();
+    ASSERT_EQ(report.mDistinctCount, 2u);
+    ASSERT_EQ(report.mReferencesCount, 3u);
+    ASSERT_EQ(report.mReferencedBytes, 3 * sizeof(AggregatedBitset<RULES_COUNT>));
+
+    pool.release(first);
+    ASSERT_EQ(pool.distinctCount(), 2u);
+    pool.release(second);
+    ASSERT_EQ(pool.distinctCount(), 1u);
+    pool.release(other);
+    ASSERT_EQ(pool.referencesCount(), 0u);
+}
+
+TEST(AggregatedBitsetTests, RowsCountIsBounded)
+{
+    using Bitset = AggregatedBitset<RULES_COUNT>;
+    auto bitset = std::make_unique<Bitset>();
+    bitset->set(7);
+    auto result = std::make_unique<Bitset>();
+    std::vector<const Bitset *> rows(Bitset::MAX_ROWS + 1, bitset.get());
+    uint32_t id;
+
+    ASSERT_EQ(Bitset::OperateANDFirst(rows.data(), Bitset::MAX_ROWS), 7u);
+    ASSERT_THROW(Bitset::OperateANDFirst(rows.data(), rows.size()), std::invalid_argument);
+    ASSERT_THROW(Bitset::OperateANDTopK(rows.data(), rows.size(), &id, 1), std::invalid_argument);
+    ASSERT_THROW(Bitset::OperateAND(rows.data(), rows.size(), *result), std::invalid_argument);
+}
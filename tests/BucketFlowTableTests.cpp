@@ -0,0 +1,92 @@
+#include "FlowTable/BucketFlowTable.hpp"
+#include <gtest/gtest.h>
+
+class BucketFlowTableTests : public testing::Test
+{
+  protected:
+    BucketFlowTableTests()
+    {
+        m_FlowTable = new BucketFlowTable();
+    }
+
+    ~BucketFlowTableTests() override
+    {
+        if (m_FlowTable)
+            delete m_FlowTable;
+    }
+
+    static FiveTuple makeFiveTuple(const uint8_t protocol)
+    {
+        return FiveTuple{.mSourceAddress = 0xc0a80000,
+                         .mDestinationAddress = 0x08080808,
+                         .mSourcePort = 12345,
+                         .mDestinationPort = 80,
+                         .mProtocol = protocol};
+    }
+
+    BucketFlowTable *m_FlowTable = nullptr;
+};
+
+TEST_F(BucketFlowTableTests, LookupsAndInserts)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    const uint32_t hash = 84812345;
+    const FiveTuple fiveTuple = makeFiveTuple(6);
+
+    ASSERT_FALSE(m_FlowTable->lookup(hash, fiveTuple));
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(m_FlowTable->insert(hash, fiveTuple, 100));
+    }
+
+    ASSERT_TRUE(m_FlowTable->lookup(hash, fiveTuple));
+    ASSERT_TRUE(m_FlowTable->lookup(hash, !fiveTuple));
+    ASSERT_EQ(m_FlowTable->lookup(hash, fiveTuple)->rules_count(), 1);
+    ASSERT_EQ(std::get<0>(m_FlowTable->lookup(hash, fiveTuple)->rule(0)), 100);
+}
+
+TEST_F(BucketFlowTableTests, ExtensionBuckets)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    // Same hash for every flow, so the home bucket overflows into extension buckets
+    const uint32_t hash = 84812345;
+    constexpr int SLOTS_COUNT = FlowBucket::SLOTS_COUNT;
+    constexpr int FLOWS_COUNT = SLOTS_COUNT * 3;
+
+    for (int i = 0; i < FLOWS_COUNT; ++i)
+    {
+        ASSERT_TRUE(m_FlowTable->insert(hash, makeFiveTuple(i), i));
+    }
+    for (int i = 0; i < FLOWS_COUNT; ++i)
+    {
+        TrackDescriptor *trackDescriptor = m_FlowTable->lookup(hash, makeFiveTuple(i));
+        ASSERT_TRUE(trackDescriptor);
+        ASSERT_EQ(std::get<0>(trackDescriptor->rule(0)), i);
+    }
+
+    // Empty the first extension bucket, the chain must stay reachable
+    for (int i = SLOTS_COUNT; i < SLOTS_COUNT * 2; ++i)
+    {
+        ASSERT_TRUE(m_FlowTable->delete_entry(hash, m_FlowTable->lookup(hash, makeFiveTuple(i))));
+        ASSERT_FALSE(m_FlowTable->lookup(hash, makeFiveTuple(i)));
+    }
+    for (int i = SLOTS_COUNT * 2; i < FLOWS_COUNT; ++i)
+    {
+        ASSERT_TRUE(m_FlowTable->lookup(hash, makeFiveTuple(i)));
+    }
+
+    uint32_t hashes[FLOWS_COUNT];
+    FiveTuple fiveTuples[FLOWS_COUNT];
+    TrackDescriptor *results[FLOWS_COUNT];
+    for (int i = 0; i < FLOWS_COUNT; ++i)
+    {
+        hashes[i] = hash;
+        fiveTuples[i] = makeFiveTuple(i);
+    }
+    ASSERT_EQ(m_FlowTable->lookup_bulk(hashes, fiveTuples, results, FLOWS_COUNT), SLOTS_COUNT * 2);
+
+    // Deleting a non-existent entry
+    ASSERT_FALSE(m_FlowTable->delete_entry(hash, nullptr));
+}
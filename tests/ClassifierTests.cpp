@@ -0,0 +1,193 @@
+#include "Classifier/Classifier.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+static constexpr size_t MAX_RULES = 4096;
+
+using RulesClassifier = Classifier<MAX_RULES>;
+
+static bool matches(const ClassifierRule &rule, const FiveTuple &fiveTuple, const uint8_t tcpFlags)
+{
+    const auto inPrefix = [](const uint32_t address, const uint32_t prefix, const uint8_t length) {
+        return length == 0 || ((address ^ prefix) >> (32 - length)) == 0;
+    };
+    return inPrefix(fiveTuple.mSourceAddress, rule.mSourceAddress, rule.mSourcePrefixLength) &&
+           inPrefix(fiveTuple.mDestinationAddress, rule.mDestinationAddress, rule.mDestinationPrefixLength) &&
+           fiveTuple.mSourcePort >= rule.mSourcePortLow && fiveTuple.mSourcePort <= rule.mSourcePortHigh &&
+           fiveTuple.mDestinationPort >= rule.mDestinationPortLow &&
+           fiveTuple.mDestinationPort <= rule.mDestinationPortHigh &&
+           ((fiveTuple.mProtocol ^ rule.mProtocol) & rule.mProtocolMask) == 0 &&
+           ((tcpFlags ^ rule.mTcpFlags) & rule.mTcpFlagsMask) == 0;
+}
+
+/// Rules drawn from a few address blocks and port ranges, so packets drawn the same way hit many of them
+static std::vector<ClassifierRule> makeRules(std::mt19937 &generator, const size_t count)
+{
+    static constexpr uint32_t BLOCKS[] = {0x0a000000, 0x0a010000, 0xc0a80000, 0xc0a80100};
+    static constexpr uint8_t PREFIX_LENGTHS[] = {0, 8, 16, 20, 24, 28, 32};
+
+    std::vector<ClassifierRule> rules(count);
+    for (ClassifierRule &rule : rules)
+    {
+        rule.mSourcePrefixLength = PREFIX_LENGTHS[generator() % 7];
+        rule.mSourceAddress = BLOCKS[generator() % 4] | (generator() & 0xff);
+        rule.mDestinationPrefixLength = PREFIX_LENGTHS[generator() % 7];
+        rule.mDestinationAddress = BLOCKS[generator() % 4] | (generator() & 0xff);
+        if (generator() % 2)
+        {
+            rule.mSourcePortLow = generator() % 2048;
+            rule.mSourcePortHigh = rule.mSourcePortLow + generator() % 2048;
+        }
+        if (generator() % 2)
+        {
+            rule.mDestinationPortLow = generator() % 1024;
+            rule.mDestinationPortHigh = rule.mDestinationPortLow + generator() % 64;
+        }
+        if (generator() % 2)
+        {
+            rule.mProtocol = generator() % 2 ? 6 : 17;
+            rule.mProtocolMask = 0xff;
+        }
+        if (rule.mProtocol == 6 && generator() % 2)
+        {
+            rule.mTcpFlags = 0x02;
+            rule.mTcpFlagsMask = 0x12; // SYN without ACK
+        }
+    }
+    return rules;
+}
+
+static FiveTuple makePacket(std::mt19937 &generator)
+{
+    static constexpr uint32_t BLOCKS[] = {0x0a000000, 0x0a010000, 0xc0a80000, 0xc0a80100, 0x08080800};
+    return FiveTuple{.mSourceAddress = static_cast<uint32_t>(BLOCKS[generator() % 5] | (generator() & 0xff)),
+                     .mDestinationAddress = static_cast<uint32_t>(BLOCKS[generator() % 5] | (generator() & 0xff)),
+                     .mSourcePort = static_cast<uint16_t>(generator() % 4096),
+                     .mDestinationPort = static_cast<uint16_t>(generator() % 1100),
+                     .mProtocol = static_cast<uint8_t>(generator() % 3 ? 6 : 17)};
+}
+
+TEST(ClassifierTests, PrefixTrieLongestMatch)
+{
+    const int any = 0, tenSlash8 = 1, tenSlash16 = 2, host = 3, tenSlash12 = 4;
+    PrefixTrie<int> trie(&any);
+    trie.insert(0x0a000000, 8, &tenSlash8);
+    trie.insert(0x0a100000, 12, &tenSlash12);
+    trie.insert(0x0a010000, 16, &tenSlash16);
+    trie.insert(0x0a010203, 32, &host);
+
+    ASSERT_EQ(trie.lookup(0x0b000000), &any);
+    ASSERT_EQ(trie.lookup(0x0a000001), &tenSlash8);
+    ASSERT_EQ(trie.lookup(0x0a1f0000), &tenSlash12);
+    ASSERT_EQ(trie.lookup(0x0a200000), &tenSlash8);
+    ASSERT_EQ(trie.lookup(0x0a010204), &tenSlash16);
+    ASSERT_EQ(trie.lookup(0x0a010203), &host);
+}
+
+TEST(ClassifierTests, IntervalTableLookup)
+{
+    const int none = 0, low = 1, both = 2;
+    IntervalTable<int> table;
+    table.append(0, &none);
+    table.append(80, &low);
+    table.append(100, &both);
+    table.append(200, &both); // merged with the previous interval
+    table.append(1024, &none);
+
+    ASSERT_EQ(table.intervalsCount(), 4u);
+    ASSERT_EQ(table.lookup(0), &none);
+    ASSERT_EQ(table.lookup(79), &none);
+    ASSERT_EQ(table.lookup(80), &low);
+    ASSERT_EQ(table.lookup(250), &both);
+    ASSERT_EQ(table.lookup(1023), &both);
+    ASSERT_EQ(table.lookup(65535), &none);
+}
+
+TEST(ClassifierTests, ClassifyMatchesLinearSearch)
+{
+    std::mt19937 generator(1);
+    const std::vector<ClassifierRule> rules = makeRules(generator, MAX_RULES);
+    const auto classifier = std::make_unique<RulesClassifier>(rules);
+    ASSERT_EQ(classifier->rulesCount(), MAX_RULES);
+
+    size_t matched = 0;
+    for (int packet = 0; packet < 2000; ++packet)
+    {
+        const FiveTuple fiveTuple = makePacket(generator);
+        const uint8_t tcpFlags = fiveTuple.mProtocol == 6 ? static_cast<uint8_t>(generator() % 2 ? 0x02 : 0x12) : 0;
+
+        std::vector<uint32_t> expectedIds;
+        for (uint32_t rule = 0; rule < rules.size(); ++rule)
+        {
+            if (matches(rules[rule], fiveTuple, tcpFlags))
+                expectedIds.push_back(rule);
+        }
+
+        const size_t first = classifier->classify(fiveTuple, tcpFlags);
+        ASSERT_EQ(first, expectedIds.empty() ? RulesClassifier::NO_MATCH : expectedIds[0]) << packet;
+
+        uint32_t ids[8];
+        const size_t found = classifier->classify(fiveTuple, tcpFlags, ids, 8);
+        ASSERT_EQ(found, std::min<size_t>(expectedIds.size(), 8)) << packet;
+        ASSERT_TRUE(std::equal(ids, ids + found, expectedIds.begin())) << packet;
+        matched += !expectedIds.empty();
+    }
+    ASSERT_GT(matched, 1000u);
+}
+
+TEST(ClassifierTests, WildcardsAndEdges)
+{
+    std::vector<ClassifierRule> rules(3);
+    rules[0].mDestinationPortLow = rules[0].mDestinationPortHigh = UINT16_MAX;
+    rules[1].mSourceAddress = 0xffffffff;
+    rules[1].mSourcePrefixLength = 32;
+    // rules[2] matches everything
+    const auto classifier = std::make_unique<RulesClassifier>(rules);
+
+    ASSERT_EQ(classifier->classify(FiveTuple{.mDestinationPort = UINT16_MAX}), 0u);
+    ASSERT_EQ(classifier->classify(FiveTuple{.mSourceAddress = 0xffffffff}), 1u);
+    ASSERT_EQ(classifier->classify(FiveTuple{}), 2u);
+
+    rules[1].mSourcePortLow = 10;
+    rules[1].mSourcePortHigh = 9;
+    ASSERT_THROW(RulesClassifier{rules}, std::invalid_argument);
+    ASSERT_THROW(RulesClassifier{std::vector<ClassifierRule>(MAX_RULES + 1)}, std::invalid_argument);
+}
+
+TEST(ClassifierTests, LeavesShareCanonicalBitsets)
+{
+    std::mt19937 generator(2);
+    const std::vector<ClassifierRule> rules = makeRules(generator, MAX_RULES);
+    auto pool = std::make_shared<RulesClassifier::RuleBitsetPool>();
+
+    auto classifier = std::make_unique<RulesClassifier>(rules, pool);
+    const ClassifierMemoryReport report = classifier->memoryReport();
+    ASSERT_EQ(report.mLeavesCount, pool->referencesCount());
+    ASSERT_EQ(report.mBitsetsCount, pool->distinctCount());
+    ASSERT_LT(report.mBitsetsCount, report.mLeavesCount);
+    ASSERT_EQ(report.mUnsharedBitsetBytes, report.mLeavesCount * sizeof(RulesClassifier::RuleBitset));
+    ASSERT_GT(report.mStructureBytes, 0u);
+
+    // A second classifier over the same rules adds references, not bitsets
+    auto rebuilt = std::make_unique<RulesClassifier>(rules, pool);
+    ASSERT_EQ(pool->distinctCount(), report.mBitsetsCount);
+    ASSERT_EQ(pool->referencesCount(), 2 * report.mLeavesCount);
+
+    classifier.reset();
+    ASSERT_EQ(pool->referencesCount(), report.mLeavesCount);
+    const FiveTuple fiveTuple{.mSourceAddress = 0x0a000001, .mProtocol = 17};
+    size_t expected = RulesClassifier::NO_MATCH;
+    for (uint32_t rule = 0; rule < rules.size() && expected == RulesClassifier::NO_MATCH; ++rule)
+    {
+        if (matches(rules[rule], fiveTuple, 0))
+            expected = rule;
+    }
+    ASSERT_EQ(rebuilt->classify(fiveTuple), expected);
+
+    rebuilt.reset();
+    ASSERT_EQ(pool->referencesCount(), 0u);
+    ASSERT_EQ(pool->distinctCount(), 0u);
+}
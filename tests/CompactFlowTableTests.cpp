@@ -0,0 +1,91 @@
+#include "FlowTable/CompactFlowTable.hpp"
+#include <gtest/gtest.h>
+
+class CompactFlowTableTests : public testing::Test
+{
+  protected:
+    CompactFlowTableTests()
+    {
+        m_FlowTable = new CompactFlowTable();
+    }
+
+    ~CompactFlowTableTests() override
+    {
+        if (m_FlowTable)
+            delete m_FlowTable;
+    }
+
+    static FiveTuple makeFiveTuple(const uint8_t protocol)
+    {
+        return FiveTuple{.mSourceAddress = 0xc0a80000,
+                         .mDestinationAddress = 0x08080808,
+                         .mSourcePort = 12345,
+                         .mDestinationPort = 80,
+                         .mProtocol = protocol};
+    }
+
+    CompactFlowTable *m_FlowTable = nullptr;
+};
+
+TEST_F(CompactFlowTableTests, LookupsAndInserts)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    const uint32_t hash = 84812345;
+    const FiveTuple fiveTuple = makeFiveTuple(6);
+
+    ASSERT_FALSE(m_FlowTable->lookup(hash, fiveTuple));
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(m_FlowTable->insert(hash, fiveTuple, 100));
+    }
+    ASSERT_EQ(m_FlowTable->size(), 1u);
+
+    FlowDirection direction;
+    TrackDescriptor *trackDescriptor = m_FlowTable->lookup(hash, fiveTuple, &direction);
+    ASSERT_TRUE(trackDescriptor);
+    ASSERT_EQ(direction, FlowDirection::Forward); // relative to the first packet
+    ASSERT_EQ(m_FlowTable->lookup(hash, !fiveTuple, &direction), trackDescriptor);
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+    ASSERT_EQ(std::get<0>(trackDescriptor->rule(0)), 100);
+}
+
+TEST_F(CompactFlowTableTests, ChainDeletions)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    // Same head slot for every flow
+    const uint32_t hash = 84812345;
+    constexpr int FLOWS_COUNT = 8;
+
+    TrackDescriptor *trackDescriptors[FLOWS_COUNT];
+    for (int i = 0; i < FLOWS_COUNT; ++i)
+    {
+        auto [trackDescriptor, inserted] =
+            m_FlowTable->find_or_insert(hash, makeFiveTuple(i), [](TrackDescriptor &) {});
+        ASSERT_TRUE(inserted);
+        trackDescriptors[i] = trackDescriptor;
+    }
+
+    // Middle, tail and head of the chain
+    ASSERT_TRUE(m_FlowTable->delete_entry(hash, trackDescriptors[3]));
+    ASSERT_TRUE(m_FlowTable->delete_entry(hash, trackDescriptors[0]));
+    ASSERT_TRUE(m_FlowTable->delete_entry(hash, trackDescriptors[FLOWS_COUNT - 1]));
+    ASSERT_FALSE(m_FlowTable->delete_entry(hash, trackDescriptors[3]));
+    ASSERT_EQ(m_FlowTable->size(), static_cast<uint32_t>(FLOWS_COUNT - 3));
+
+    FiveTuple keys[FLOWS_COUNT];
+    uint32_t hashes[FLOWS_COUNT];
+    TrackDescriptor *out[FLOWS_COUNT];
+    for (int i = 0; i < FLOWS_COUNT; ++i)
+    {
+        keys[i] = makeFiveTuple(i);
+        hashes[i] = hash;
+    }
+    ASSERT_EQ(m_FlowTable->lookup_bulk(hashes, keys, out, FLOWS_COUNT), static_cast<uint32_t>(FLOWS_COUNT - 3));
+    for (int i = 0; i < FLOWS_COUNT; ++i)
+    {
+        const bool deleted = (i == 0 || i == 3 || i == FLOWS_COUNT - 1);
+        ASSERT_EQ(out[i], deleted ? nullptr : trackDescriptors[i]);
+    }
+}
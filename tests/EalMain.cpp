@@ -0,0 +1,23 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <rte_eal.h>
+
+/// Entry point of the tests that allocate from DPDK: mempools, rte_malloc and the RCU QSBR. The EAL runs
+/// on anonymous memory, so the tests need neither hugepages nor a runtime directory.
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    const char *args[] = {"cheetah-flow-tests", "-l", "0", "--no-huge", "--in-memory", "-m", "512", NULL};
+    if (rte_eal_init(7, const_cast<char **>(args)) < 0)
+    {
+        std::cerr << "Failed to initialize EAL" << std::endl;
+        return 1;
+    }
+
+    auto all_tests_return_code = RUN_ALL_TESTS();
+
+    rte_eal_cleanup();
+
+    return all_tests_return_code;
+}
@@ -1,5 +1,8 @@
 #include "FlowTable/FlowTable.hpp"
+#include "FlowTable/ShardedFlowTable.hpp"
+#include "NewFlowTable.hpp"
 #include <gtest/gtest.h>
+#include <vector>
 
 // The fixture for testing class Foo.
 class FlowTableTests : public testing::Test
@@ -10,7 +13,7 @@ class FlowTableTests : public testing::Test
 
     FlowTableTests()
     {
-        m_FlowTable = new FlowTable();
+        m_FlowTable = new FlowTable("FlowTableTests", 1 << 16);
     }
 
     ~FlowTableTests() override
@@ -65,7 +68,39 @@ TEST_F(FlowTableTests, LookupsAndInserts)
     }
 
     ASSERT_TRUE(m_FlowTable->lookup(hash1, fiveTuple1));
-    ASSERT_EQ(std::get<0>(m_FlowTable->lookup(hash1, fiveTuple1)->mMatchedRules[0]), 100);
+    ASSERT_EQ(std::get<0>(m_FlowTable->lookup(hash1, fiveTuple1)->rule(0)), 100);
+}
+
+TEST_F(FlowTableTests, MatchedRulesOverflow)
+{
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    ASSERT_TRUE(m_FlowTable->insert(hash1, fiveTuple, 0));
+    TrackDescriptor *trackDescriptor = m_FlowTable->lookup(hash1, fiveTuple);
+    ASSERT_EQ(trackDescriptor->rules_count(), 1);
+
+    // The overflow block is only allocated past the inline rules
+    ASSERT_TRUE(m_FlowTable->add_matched_rule(trackDescriptor, 1));
+    ASSERT_EQ(trackDescriptor->mRules, nullptr);
+    for (uint16_t ruleId = 2; ruleId < TrackDescriptor::RULES_CAPACITY; ++ruleId)
+    {
+        ASSERT_TRUE(m_FlowTable->add_matched_rule(trackDescriptor, ruleId));
+    }
+    ASSERT_NE(trackDescriptor->mRules, nullptr);
+    ASSERT_FALSE(m_FlowTable->add_matched_rule(trackDescriptor, TrackDescriptor::RULES_CAPACITY));
+
+    ASSERT_EQ(trackDescriptor->rules_count(), TrackDescriptor::RULES_CAPACITY);
+    for (uint8_t i = 0; i < trackDescriptor->rules_count(); ++i)
+    {
+        ASSERT_EQ(std::get<0>(trackDescriptor->rule(i)), i);
+    }
+
+    ASSERT_TRUE(m_FlowTable->delete_entry(hash1, trackDescriptor));
 }
 
 TEST_F(FlowTableTests, Deletions)
@@ -132,4 +167,568 @@ TEST_F(FlowTableTests, Deletions)
     ASSERT_FALSE(m_FlowTable->delete_entry(hash1, lookup_result));
     lookup_result = m_FlowTable->lookup(hash1, fiveTuple);
     ASSERT_FALSE(lookup_result);
-}
\ No newline at end of file
+}
+TEST_F(FlowTableTests, BulkLookups)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    constexpr uint32_t BURST_SIZE = 40;
+    uint32_t hashes[BURST_SIZE];
+    FiveTuple fiveTuples[BURST_SIZE];
+    TrackDescriptor *results[BURST_SIZE];
+
+    for (uint32_t i = 0; i < BURST_SIZE; ++i)
+    {
+        hashes[i] = 84812345 + (i % 4) * 0x100; // a few chains with several flows each
+        fiveTuples[i] = FiveTuple{.mSourceAddress = 0xc0a80000 + i,
+                                  .mDestinationAddress = 0x08080808,
+                                  .mSourcePort = 12345,
+                                  .mDestinationPort = 80,
+                                  .mProtocol = 6};
+    }
+
+    // Only the even flows are tracked
+    for (uint32_t i = 0; i < BURST_SIZE; i += 2)
+    {
+        ASSERT_TRUE(m_FlowTable->insert(hashes[i], fiveTuples[i], i));
+    }
+
+    ASSERT_EQ(m_FlowTable->lookup_bulk(hashes, fiveTuples, results, BURST_SIZE), BURST_SIZE / 2);
+    for (uint32_t i = 0; i < BURST_SIZE; ++i)
+    {
+        ASSERT_EQ(results[i], m_FlowTable->lookup(hashes[i], fiveTuples[i]));
+        ASSERT_EQ(results[i] != nullptr, i % 2 == 0);
+    }
+}
+
+TEST_F(FlowTableTests, CanonicalKeyAndDirection)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+    FiveTuple fiveTupleRev = !fiveTuple;
+
+    FlowDirection direction;
+    ASSERT_EQ(fiveTuple.canonical(direction), fiveTupleRev);
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+    ASSERT_EQ(fiveTupleRev.canonical(direction), fiveTupleRev);
+    ASSERT_EQ(direction, FlowDirection::Forward);
+
+    ASSERT_TRUE(m_FlowTable->insert(hash1, fiveTuple, 100));
+
+    // The table reports directions relative to the first packet, not to the canonical key
+    TrackDescriptor *forward = m_FlowTable->lookup(hash1, fiveTuple, &direction);
+    ASSERT_TRUE(forward);
+    ASSERT_EQ(direction, FlowDirection::Forward);
+
+    ASSERT_EQ(m_FlowTable->lookup(hash1, fiveTupleRev, &direction), forward);
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+
+    // The parse path canonicalizes once, a miss and the insert that follows reuse the key
+    uint32_t hash2 = 84812346;
+    FiveTuple otherFiveTuple = fiveTuple;
+    otherFiveTuple.mSourcePort = 54321;
+    FlowDirection packetDirection;
+    const FiveTuple canonicalFiveTuple = otherFiveTuple.canonical(packetDirection);
+
+    ASSERT_FALSE(m_FlowTable->lookup(hash2, canonicalFiveTuple, packetDirection, &direction));
+    ASSERT_EQ(direction, FlowDirection::Forward);
+    ASSERT_TRUE(m_FlowTable->insert(hash2, canonicalFiveTuple, packetDirection, 101));
+    TrackDescriptor *other = m_FlowTable->lookup(hash2, canonicalFiveTuple, packetDirection, &direction);
+    ASSERT_TRUE(other);
+    ASSERT_EQ(direction, FlowDirection::Forward);
+    ASSERT_EQ(m_FlowTable->lookup(hash2, otherFiveTuple), other);
+
+    TrackDescriptor *out[1];
+    FlowDirection directions[1];
+    const FiveTuple keys[] = {!otherFiveTuple};
+    ASSERT_EQ(m_FlowTable->lookup_bulk(&hash2, &canonicalFiveTuple, &packetDirection, out, 1), 1u);
+    ASSERT_EQ(out[0], other);
+    ASSERT_EQ(m_FlowTable->lookup_bulk(&hash2, keys, out, 1, directions), 1u);
+    ASSERT_EQ(out[0], other);
+    ASSERT_EQ(directions[0], FlowDirection::Reverse);
+
+    // A flow first seen in canonical order has the same orientation as its key
+    uint32_t hash3 = 84812347;
+    ASSERT_TRUE(m_FlowTable->insert(hash3, fiveTupleRev, 102));
+    ASSERT_TRUE(m_FlowTable->lookup(hash3, fiveTupleRev, &direction));
+    ASSERT_EQ(direction, FlowDirection::Forward);
+    ASSERT_TRUE(m_FlowTable->lookup(hash3, fiveTuple, &direction));
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+}
+
+TEST(ShardedFlowTableTests, CrossShardLookups)
+{
+    ShardedFlowTable shardedFlowTable(2, "ShardedFlowTable", 1 << 16);
+    ASSERT_EQ(shardedFlowTable.shard(0).capacity(), 1u << 15); // the capacity is split between the shards
+    ASSERT_EQ(shardedFlowTable.shard(1).capacity(), 1u << 15);
+    shardedFlowTable.shard(1).set_aging(UINT64_MAX / 2);
+
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    ASSERT_TRUE(shardedFlowTable.insert(1, hash1, fiveTuple, 100));
+    ASSERT_TRUE(shardedFlowTable.lookup(1, hash1, fiveTuple));
+    ASSERT_FALSE(shardedFlowTable.lookup(0, hash1, fiveTuple));
+
+    // The reply arrives on the other queue, the probe leaves the owner's aging state alone
+    const uint64_t lastSeen = shardedFlowTable.lookup(1, hash1, fiveTuple)->mLastSeen;
+    uint16_t ownerQueueId = 0;
+    FlowDirection direction;
+    TrackDescriptor *trackDescriptor = shardedFlowTable.lookup_any(0, hash1, !fiveTuple, &ownerQueueId, &direction);
+    ASSERT_EQ(trackDescriptor->mLastSeen, lastSeen);
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+    ASSERT_EQ(trackDescriptor, shardedFlowTable.lookup(1, hash1, fiveTuple));
+    ASSERT_EQ(ownerQueueId, 1);
+    ASSERT_EQ(shardedFlowTable.crossShardLookups(0), 1);
+    ASSERT_EQ(shardedFlowTable.crossShardHits(0), 1);
+
+    ASSERT_TRUE(shardedFlowTable.delete_entry(ownerQueueId, hash1, trackDescriptor));
+    ASSERT_FALSE(shardedFlowTable.lookup_any(0, hash1, fiveTuple));
+    ASSERT_EQ(shardedFlowTable.crossShardLookups(0), 2);
+}
+
+TEST(ShardedFlowTableTests, SmallShards)
+{
+    // 1024 flows and 256 rules per shard, below the flush threshold of the default shard cache
+    ShardedFlowTable shardedFlowTable(4, "SmallShardedFlowTable", 4096);
+    ASSERT_EQ(shardedFlowTable.shard(3).capacity(), 1024u);
+
+    const FiveTuple fiveTuple{.mSourceAddress = 0x0a000001, .mDestinationAddress = 0x0a000002, .mProtocol = 17};
+    ASSERT_TRUE(shardedFlowTable.insert(3, 84812345, fiveTuple, 100));
+    ASSERT_TRUE(shardedFlowTable.lookup(3, 84812345, fiveTuple));
+}
+
+TEST(ShardedFlowTableTests, NumaPlacement)
+{
+    const std::vector<unsigned> queueLcores{0, 0};
+    ShardedFlowTable shardedFlowTable(queueLcores, "NumaShardedFlowTable", 1 << 16);
+    ASSERT_EQ(shardedFlowTable.shardsCount(), 2);
+
+    for (uint16_t queueId = 0; queueId < shardedFlowTable.shardsCount(); ++queueId)
+    {
+        const int socketId = static_cast<int>(rte_lcore_to_socket_id(queueLcores[queueId]));
+        ASSERT_EQ(shardedFlowTable.socketId(queueId), socketId);
+        ASSERT_EQ(shardedFlowTable.shard(queueId).socket_id(), socketId);
+    }
+
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    // Both queues are polled from the local socket, nothing is remote
+    ASSERT_TRUE(shardedFlowTable.insert(1, hash1, fiveTuple, 100));
+    ASSERT_TRUE(shardedFlowTable.lookup(1, hash1, fiveTuple));
+    ASSERT_TRUE(shardedFlowTable.lookup_any(0, hash1, !fiveTuple));
+    ASSERT_EQ(shardedFlowTable.crossNodeLookups(0), 0);
+    ASSERT_EQ(shardedFlowTable.crossNodeLookups(1), 0);
+    ASSERT_EQ(shardedFlowTable.crossNodeHits(0), 0);
+}
+
+TEST_F(FlowTableTests, RcuDeferredReclamation)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+    constexpr unsigned READER_ID = 0;
+
+    rte_rcu_qsbr *rcu = reinterpret_cast<rte_rcu_qsbr *>(rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(1), 64));
+    ASSERT_TRUE(rcu);
+    ASSERT_EQ(rte_rcu_qsbr_init(rcu, 1), 0);
+    m_FlowTable->attach_rcu(rcu);
+
+    rte_mempool *trackBucketsPool = rte_mempool_lookup("FlowTableTests_tbmp");
+    ASSERT_TRUE(trackBucketsPool);
+    const unsigned available = rte_mempool_avail_count(trackBucketsPool);
+
+    // This thread also plays the reader, online from here on
+    ASSERT_EQ(rte_rcu_qsbr_thread_register(rcu, READER_ID), 0);
+    rte_rcu_qsbr_thread_online(rcu, READER_ID);
+
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_TRUE(m_FlowTable->insert(hash1, fiveTuple, 100));
+        TrackDescriptor *trackDescriptor = m_FlowTable->lookup(hash1, fiveTuple);
+        ASSERT_TRUE(m_FlowTable->delete_entry(hash1, trackDescriptor));
+        ASSERT_FALSE(m_FlowTable->lookup(hash1, fiveTuple));
+
+        // The reader may still stand on the deleted track bucket, it stays out of the pool
+        m_FlowTable->reclaim();
+        ASSERT_EQ(rte_mempool_avail_count(trackBucketsPool), available - 1);
+
+        rte_rcu_qsbr_quiescent(rcu, READER_ID);
+        m_FlowTable->reclaim();
+        ASSERT_EQ(rte_mempool_avail_count(trackBucketsPool), available);
+    }
+
+    // A deletion still in its grace period when the table goes away
+    ASSERT_TRUE(m_FlowTable->insert(hash1, fiveTuple, 100));
+    ASSERT_TRUE(m_FlowTable->delete_entry(hash1, m_FlowTable->lookup(hash1, fiveTuple)));
+    rte_rcu_qsbr_thread_offline(rcu, READER_ID);
+
+    delete m_FlowTable;
+    m_FlowTable = nullptr;
+    rte_rcu_qsbr_thread_unregister(rcu, READER_ID);
+    rte_free(rcu);
+}
+
+static void countExpired(const FiveTuple &, TrackDescriptor *, void *arg)
+{
+    ++*static_cast<int *>(arg);
+}
+
+TEST_F(FlowTableTests, IncrementalAging)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    constexpr uint64_t TTL_CYCLES = 1000000;
+    int expiredCount = 0;
+    m_FlowTable->set_aging(TTL_CYCLES, countExpired, &expiredCount);
+
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    // Two flows on slot 0x10, one on slot 0x20
+    const uint32_t hashes[] = {0x1001, 0x1002, 0x2001};
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        fiveTuple.mSourcePort = 12345 + i;
+        ASSERT_TRUE(m_FlowTable->insert(hashes[i], fiveTuple, 100));
+    }
+
+    // Flow 0x1002 stays active
+    fiveTuple.mSourcePort = 12346;
+    TrackDescriptor *activeTrackDescriptor = m_FlowTable->lookup(hashes[1], fiveTuple);
+    ASSERT_TRUE(activeTrackDescriptor);
+    const uint64_t now = activeTrackDescriptor->mLastSeen + TTL_CYCLES / 2;
+    activeTrackDescriptor->mLastSeen += TTL_CYCLES;
+
+    // The budget only reaches slot 0x10
+    ASSERT_EQ(m_FlowTable->age(0x11, now + TTL_CYCLES), 1);
+    ASSERT_EQ(expiredCount, 1);
+    ASSERT_TRUE(m_FlowTable->lookup(hashes[1], fiveTuple));
+
+    // The next call resumes from slot 0x11
+    ASSERT_EQ(m_FlowTable->age(0x10, now + TTL_CYCLES), 1);
+    ASSERT_EQ(expiredCount, 2);
+    fiveTuple.mSourcePort = 12347;
+    ASSERT_FALSE(m_FlowTable->lookup(hashes[2], fiveTuple));
+}
+
+TEST_F(FlowTableTests, AgingKeepsFlowsHitAfterNow)
+{
+    ASSERT_NE(m_FlowTable, nullptr);
+
+    int expiredCount = 0;
+    m_FlowTable->set_aging(1000000, countExpired, &expiredCount);
+
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    // `now` sampled at the start of the poll iteration, the flow is inserted and hit after it
+    const uint64_t now = rte_rdtsc();
+    ASSERT_TRUE(m_FlowTable->insert(hash1, fiveTuple, 100));
+    TrackDescriptor *trackDescriptor = m_FlowTable->lookup(hash1, fiveTuple);
+    ASSERT_TRUE(trackDescriptor);
+    ASSERT_GE(trackDescriptor->mLastSeen, now);
+
+    ASSERT_EQ(m_FlowTable->age(m_FlowTable->slotsCount(), now), 0u);
+    ASSERT_EQ(expiredCount, 0);
+    ASSERT_EQ(m_FlowTable->lookup(hash1, fiveTuple), trackDescriptor);
+}
+
+TEST_F(FlowTableTests, FindOrInsert)
+{
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+    int initCalls = 0;
+    auto init = [&initCalls](TrackDescriptor &trackDescriptor) {
+        trackDescriptor.add_rule(std::make_tuple(7, 100), nullptr);
+        ++initCalls;
+    };
+
+    FlowDirection direction;
+    auto [inserted, isNew] = m_FlowTable->find_or_insert(hash1, fiveTuple, init, &direction);
+    ASSERT_TRUE(inserted);
+    ASSERT_TRUE(isNew);
+    ASSERT_EQ(direction, FlowDirection::Forward); // the inserting packet initiates the flow
+    ASSERT_EQ(std::get<0>(inserted->rule(0)), 7);
+
+    auto [found, foundIsNew] = m_FlowTable->find_or_insert(hash1, !fiveTuple, init, &direction);
+    ASSERT_EQ(found, inserted);
+    ASSERT_FALSE(foundIsNew);
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+    ASSERT_EQ(initCalls, 1);
+    ASSERT_EQ(m_FlowTable->lookup(hash1, fiveTuple), inserted);
+}
+
+TEST_F(FlowTableTests, EvictionOldestInBucket)
+{
+    FiveTuple fiveTuples[4];
+    for (uint16_t i = 0; i < 4; ++i)
+        fiveTuples[i] = FiveTuple{.mSourceAddress = 0xc0a80000,
+                                  .mDestinationAddress = 0x08080808,
+                                  .mSourcePort = static_cast<uint16_t>(1000 + i),
+                                  .mDestinationPort = 80,
+                                  .mProtocol = 6};
+
+    // All the flows share head slot 1
+    m_FlowTable->set_eviction(EvictionPolicy::OldestInBucket, 3);
+    for (uint32_t i = 0; i < 3; ++i)
+        ASSERT_TRUE(m_FlowTable->insert(0x100 | i, fiveTuples[i], 100));
+    ASSERT_EQ(m_FlowTable->size(), 3u);
+
+    ASSERT_TRUE(m_FlowTable->lookup(0x100, fiveTuples[0])); // refresh the oldest one
+    ASSERT_TRUE(m_FlowTable->insert(0x103, fiveTuples[3], 100));
+
+    ASSERT_EQ(m_FlowTable->size(), 3u);
+    ASSERT_EQ(m_FlowTable->evictionStats().mEvictions, 1u);
+    ASSERT_TRUE(m_FlowTable->lookup(0x100, fiveTuples[0]));
+    ASSERT_EQ(m_FlowTable->lookup(0x101, fiveTuples[1]), nullptr);
+    ASSERT_TRUE(m_FlowTable->lookup(0x102, fiveTuples[2]));
+    ASSERT_TRUE(m_FlowTable->lookup(0x103, fiveTuples[3]));
+}
+
+TEST_F(FlowTableTests, EvictionClock)
+{
+    FiveTuple fiveTuples[4];
+    for (uint16_t i = 0; i < 4; ++i)
+        fiveTuples[i] = FiveTuple{.mSourceAddress = 0xc0a80000,
+                                  .mDestinationAddress = 0x08080808,
+                                  .mSourcePort = static_cast<uint16_t>(1000 + i),
+                                  .mDestinationPort = 80,
+                                  .mProtocol = 6};
+
+    // Flow i lives in head slot i + 1, the hand starts at slot 0
+    m_FlowTable->set_eviction(EvictionPolicy::Clock, 3);
+    for (uint32_t i = 0; i < 3; ++i)
+        ASSERT_TRUE(m_FlowTable->insert((i + 1) << 8, fiveTuples[i], 100));
+
+    ASSERT_TRUE(m_FlowTable->lookup(1 << 8, fiveTuples[0])); // second chance for the first flow
+    ASSERT_TRUE(m_FlowTable->insert(4 << 8, fiveTuples[3], 100));
+
+    ASSERT_EQ(m_FlowTable->size(), 3u);
+    ASSERT_EQ(m_FlowTable->evictionStats().mEvictions, 1u);
+    ASSERT_TRUE(m_FlowTable->lookup(1 << 8, fiveTuples[0]));
+    ASSERT_EQ(m_FlowTable->lookup(2 << 8, fiveTuples[1]), nullptr);
+    ASSERT_TRUE(m_FlowTable->lookup(3 << 8, fiveTuples[2]));
+    ASSERT_TRUE(m_FlowTable->lookup(4 << 8, fiveTuples[3]));
+}
+
+TEST_F(FlowTableTests, EvictionSampledLru)
+{
+    FiveTuple fiveTuples[4];
+    for (uint16_t i = 0; i < 4; ++i)
+        fiveTuples[i] = FiveTuple{.mSourceAddress = 0xc0a80000,
+                                  .mDestinationAddress = 0x08080808,
+                                  .mSourcePort = static_cast<uint16_t>(1000 + i),
+                                  .mDestinationPort = 80,
+                                  .mProtocol = 6};
+
+    // The sample covers every flow, so the least recently seen one is evicted
+    int expiredCount = 0;
+    m_FlowTable->set_aging(UINT64_MAX / 2, countExpired, &expiredCount);
+    m_FlowTable->set_eviction(EvictionPolicy::SampledLru, 3, 16);
+    for (uint32_t i = 0; i < 3; ++i)
+        ASSERT_TRUE(m_FlowTable->insert((i + 1) << 8, fiveTuples[i], 100));
+
+    ASSERT_TRUE(m_FlowTable->lookup(1 << 8, fiveTuples[0])); // refresh the oldest one
+    ASSERT_TRUE(m_FlowTable->insert(4 << 8, fiveTuples[3], 100));
+
+    ASSERT_EQ(m_FlowTable->size(), 3u);
+    ASSERT_EQ(m_FlowTable->evictionStats().mEvictions, 1u);
+    ASSERT_EQ(expiredCount, 1);
+    ASSERT_TRUE(m_FlowTable->lookup(1 << 8, fiveTuples[0]));
+    ASSERT_EQ(m_FlowTable->lookup(2 << 8, fiveTuples[1]), nullptr);
+    ASSERT_TRUE(m_FlowTable->lookup(3 << 8, fiveTuples[2]));
+    ASSERT_TRUE(m_FlowTable->lookup(4 << 8, fiveTuples[3]));
+}
+
+TEST(FlowTableEvictionTests, EvictsAndRetriesWhenThePoolIsEmpty)
+{
+    FlowTable flowTable("FlowTableEvictRetry", 4);
+    FiveTuple fiveTuples[5];
+    for (uint16_t i = 0; i < 5; ++i)
+        fiveTuples[i] = FiveTuple{.mSourceAddress = 0xc0a80000,
+                                  .mDestinationAddress = 0x08080808,
+                                  .mSourcePort = static_cast<uint16_t>(1000 + i),
+                                  .mDestinationPort = 80,
+                                  .mProtocol = 6};
+
+    // The watermark is above the pool size, only the empty pool triggers an eviction
+    for (uint32_t i = 0; i < 4; ++i)
+        ASSERT_TRUE(flowTable.insert((i + 1) << 8, fiveTuples[i], 100));
+    ASSERT_FALSE(flowTable.insert(5 << 8, fiveTuples[4], 100));
+    ASSERT_EQ(flowTable.evictionStats().mInsertFailures, 1u);
+
+    flowTable.set_eviction(EvictionPolicy::SampledLru, 5, 16);
+    for (uint32_t i = 1; i < 4; ++i)
+        ASSERT_TRUE(flowTable.lookup((i + 1) << 8, fiveTuples[i]));
+    ASSERT_TRUE(flowTable.insert(5 << 8, fiveTuples[4], 100));
+
+    ASSERT_EQ(flowTable.size(), 4u);
+    ASSERT_EQ(flowTable.evictionStats().mEvictions, 1u);
+    ASSERT_EQ(flowTable.evictionStats().mInsertFailures, 1u);
+    ASSERT_EQ(flowTable.lookup(1 << 8, fiveTuples[0]), nullptr);
+    ASSERT_TRUE(flowTable.lookup(5 << 8, fiveTuples[4]));
+}
+
+TEST_F(FlowTableTests, PerDirectionCounters)
+{
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+
+    ASSERT_FALSE(m_FlowTable->lookup_and_account(hash1, fiveTuple, 60, 0x02));
+    ASSERT_TRUE(m_FlowTable->insert(hash1, fiveTuple, 100));
+
+    // `fiveTuple` initiated the flow, so it is Forward even though its canonical tuple is reversed
+    FlowDirection direction;
+    TrackDescriptor *trackDescriptor = m_FlowTable->lookup_and_account(hash1, fiveTuple, 60, 0x02, &direction);
+    ASSERT_TRUE(trackDescriptor);
+    ASSERT_EQ(direction, FlowDirection::Forward);
+    ASSERT_EQ(m_FlowTable->lookup_and_account(hash1, !fiveTuple, 1500, 0x12), trackDescriptor);
+    ASSERT_EQ(m_FlowTable->lookup_and_account(hash1, fiveTuple, 40, 0x10), trackDescriptor);
+
+    FlowDirection directions[1];
+    TrackDescriptor *out[1];
+    ASSERT_EQ(m_FlowTable->lookup_bulk(&hash1, &fiveTuple, out, 1, directions), 1u);
+    FlowTable::account(out[0], directions[0], 52, 0x11);
+
+    const FlowCountersSnapshot counters = FlowTable::counters(trackDescriptor);
+    const uint8_t reverse = static_cast<uint8_t>(FlowDirection::Reverse);
+    const uint8_t forward = static_cast<uint8_t>(FlowDirection::Forward);
+    ASSERT_EQ(counters.mPackets[forward], 3u);
+    ASSERT_EQ(counters.mBytes[forward], 152u);
+    ASSERT_EQ(counters.mTcpFlags[forward], 0x13);
+    ASSERT_EQ(counters.mPackets[reverse], 1u);
+    ASSERT_EQ(counters.mBytes[reverse], 1500u);
+    ASSERT_EQ(counters.mTcpFlags[reverse], 0x12);
+    ASSERT_LE(counters.mFirstSeen, counters.mLastSeen);
+    ASSERT_NE(counters.mFirstSeen, 0u);
+}
+
+TEST(FlowTableResizeTests, IncrementalGrowth)
+{
+    constexpr uint32_t FLOWS_COUNT = 4096;
+    FlowTable flowTable("FlowTableResizeTests", FLOWS_COUNT, 1.0f);
+    ASSERT_EQ(flowTable.slotsCount(), FlowTable::MIN_HEAD_SLOTS_COUNT);
+
+    auto fiveTupleOf = [](const uint32_t i) {
+        return FiveTuple{.mSourceAddress = 0xc0a80000 + i,
+                         .mDestinationAddress = 0x08080808,
+                         .mSourcePort = 12345,
+                         .mDestinationPort = 80,
+                         .mProtocol = 6};
+    };
+    auto hashOf = [](const uint32_t i) { return (i * 2654435761u) | 1; };
+
+    // Every flow stays reachable while chains migrate between the head arrays
+    std::vector<TrackDescriptor *> trackDescriptors(FLOWS_COUNT);
+    bool resized = false;
+    for (uint32_t i = 0; i < FLOWS_COUNT; ++i)
+    {
+        trackDescriptors[i] = flowTable.find_or_insert(hashOf(i), fiveTupleOf(i), [](TrackDescriptor &) {}).first;
+        ASSERT_TRUE(trackDescriptors[i]);
+        resized |= flowTable.resizing();
+        for (uint32_t j = 0; j <= i; j += 97)
+            ASSERT_EQ(flowTable.lookup(hashOf(j), fiveTupleOf(j)), trackDescriptors[j]);
+    }
+    ASSERT_TRUE(resized);
+
+    // age() finishes the pending migration
+    while (flowTable.resizing())
+        flowTable.age();
+    ASSERT_EQ(flowTable.slotsCount(), FLOWS_COUNT);
+
+    TrackDescriptor *out[FLOWS_COUNT];
+    std::vector<uint32_t> hashes(FLOWS_COUNT);
+    std::vector<FiveTuple> keys(FLOWS_COUNT);
+    for (uint32_t i = 0; i < FLOWS_COUNT; ++i)
+    {
+        hashes[i] = hashOf(i);
+        keys[i] = fiveTupleOf(i);
+    }
+    ASSERT_EQ(flowTable.lookup_bulk(hashes.data(), keys.data(), out, FLOWS_COUNT), FLOWS_COUNT);
+
+    for (uint32_t i = 0; i < FLOWS_COUNT; ++i)
+    {
+        ASSERT_EQ(out[i], trackDescriptors[i]);
+        ASSERT_TRUE(flowTable.delete_entry(hashes[i], out[i]));
+    }
+    ASSERT_EQ(flowTable.size(), 0u);
+}
+
+TEST(NewFlowTableTests, BidirectionalLookupsAndDeletions)
+{
+    NewFlowTable<1023> newFlowTable("NewFlowTableTests");
+
+    uint32_t hash1 = 84812345;
+    FiveTuple fiveTuple{.mSourceAddress = 0xc0a80000,
+                        .mDestinationAddress = 0x08080808,
+                        .mSourcePort = 12345,
+                        .mDestinationPort = 80,
+                        .mProtocol = 6};
+    FiveTuple fiveTupleRev = !fiveTuple;
+
+    ASSERT_EQ(newFlowTable.lookup(hash1, fiveTuple), nullptr);
+    ASSERT_TRUE(newFlowTable.insert(hash1, fiveTuple, 100));
+    ASSERT_TRUE(newFlowTable.insert(hash1, fiveTupleRev, 100));
+    ASSERT_EQ(newFlowTable.size(), 1u);
+
+    FlowDirection direction;
+    NewTrackDescriptor *forward = newFlowTable.lookup(hash1, fiveTuple, &direction);
+    ASSERT_TRUE(forward);
+    ASSERT_EQ(direction, FlowDirection::Forward); // `fiveTuple` initiated the flow
+    ASSERT_EQ(std::get<0>(forward->mMatchedRules[0]), 100);
+
+    ASSERT_EQ(newFlowTable.lookup(hash1, fiveTupleRev, &direction), forward);
+    ASSERT_EQ(direction, FlowDirection::Reverse);
+
+    FiveTuple unknownFiveTuple = fiveTuple;
+    unknownFiveTuple.mDestinationPort = 443;
+    FiveTuple keys[2] = {fiveTupleRev, unknownFiveTuple};
+    uint32_t hashes[2] = {hash1, hash1 + 1};
+    NewTrackDescriptor *out[2];
+    FlowDirection directions[2];
+    ASSERT_EQ(newFlowTable.lookup_bulk(hashes, keys, out, 2, directions), 1u);
+    ASSERT_EQ(out[0], forward);
+    ASSERT_EQ(directions[0], FlowDirection::Reverse);
+    ASSERT_EQ(out[1], nullptr);
+    ASSERT_EQ(directions[1], FlowDirection::Forward);
+
+    ASSERT_TRUE(newFlowTable.delete_entry(hash1, forward));
+    ASSERT_EQ(newFlowTable.lookup(hash1, fiveTuple), nullptr);
+    ASSERT_FALSE(newFlowTable.delete_entry(hash1, nullptr));
+}
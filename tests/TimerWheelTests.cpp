@@ -0,0 +1,112 @@
+#include "Common/TimerWheel/TimerWheel.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+class TimerWheelTests : public testing::Test
+{
+  protected:
+    static constexpr uint64_t TICK = 10;
+    static constexpr uint32_t SLOTS_COUNT = 8;
+
+    void SetUp() override
+    {
+        m_TimerWheel.init(TICK, SLOTS_COUNT, 0);
+    }
+
+    uint32_t advance(const uint64_t now)
+    {
+        return m_TimerWheel.advance(now, [this](TimerWheel::Node *node) { m_Expired.push_back(node); });
+    }
+
+    TimerWheel m_TimerWheel;
+    std::vector<TimerWheel::Node *> m_Expired;
+};
+
+TEST_F(TimerWheelTests, ExpiresInTickBatches)
+{
+    TimerWheel::Node first, second, third;
+    m_TimerWheel.schedule(&first, 15);
+    m_TimerWheel.schedule(&second, 19);
+    m_TimerWheel.schedule(&third, 25);
+
+    // Tick 1 has not fully elapsed yet
+    ASSERT_EQ(advance(19), 0);
+    ASSERT_EQ(advance(20), 2);
+    ASSERT_FALSE(first.linked());
+    ASSERT_FALSE(second.linked());
+    ASSERT_TRUE(third.linked());
+
+    ASSERT_EQ(advance(30), 1);
+    ASSERT_EQ(m_Expired, (std::vector<TimerWheel::Node *>{&first, &second, &third}));
+    ASSERT_EQ(m_TimerWheel.now(), 30);
+}
+
+TEST_F(TimerWheelTests, TouchMovesLazily)
+{
+    TimerWheel::Node node;
+    m_TimerWheel.schedule(&node, 15);
+
+    TimerWheel::touch(&node, 45);
+    ASSERT_EQ(advance(20), 0);
+    ASSERT_TRUE(node.linked());
+    ASSERT_EQ(advance(40), 0);
+    ASSERT_EQ(advance(50), 1);
+}
+
+TEST_F(TimerWheelTests, DeadlinesBeyondOneRevolution)
+{
+    TimerWheel::Node node;
+    m_TimerWheel.schedule(&node, TICK * SLOTS_COUNT * 3 + 5);
+
+    ASSERT_EQ(advance(TICK * SLOTS_COUNT * 3), 0);
+    ASSERT_TRUE(node.linked());
+    ASSERT_EQ(advance(TICK * SLOTS_COUNT * 3 + TICK), 1);
+}
+
+TEST_F(TimerWheelTests, CancelAndStall)
+{
+    TimerWheel::Node cancelled, late;
+    m_TimerWheel.schedule(&cancelled, 15);
+    m_TimerWheel.schedule(&late, 35);
+    TimerWheel::cancel(&cancelled);
+    ASSERT_FALSE(cancelled.linked());
+
+    // A stall of many revolutions still expires everything due in one call
+    ASSERT_EQ(advance(TICK * SLOTS_COUNT * 100), 1);
+    ASSERT_EQ(m_Expired, (std::vector<TimerWheel::Node *>{&late}));
+}
+
+TEST_F(TimerWheelTests, TouchFromReaderThread)
+{
+    static constexpr uint64_t TTL = TICK * SLOTS_COUNT * 2;
+    TimerWheel::Node node;
+    m_TimerWheel.schedule(&node, TTL);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> touches{0};
+    std::thread reader([&] {
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            TimerWheel::touch(&node, m_TimerWheel.now() + TTL);
+            touches.fetch_add(1, std::memory_order_release);
+        }
+    });
+
+    // Each advance waits for a touch past the previous one, so the deadline stays a TTL ahead of it
+    uint32_t expired = 0;
+    for (uint64_t now = TICK; now < TTL * 50; now += TICK)
+    {
+        const uint64_t seen = touches.load(std::memory_order_acquire);
+        while (touches.load(std::memory_order_acquire) == seen)
+            std::this_thread::yield();
+        expired += advance(now);
+    }
+
+    stop = true;
+    reader.join();
+    ASSERT_EQ(expired, 0);
+    ASSERT_TRUE(node.linked());
+    ASSERT_EQ(advance(TTL * 100), 1);
+}